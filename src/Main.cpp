@@ -4,52 +4,88 @@
 
 #include <QApplication>
 #include <QMessageBox>
-#include <QFile>
 #include <QStyleFactory>
 #include <QDesktopWidget>
 #include <QSettings>
 
 #include "gui/MainWindow.h"
+#include "gfx/VolumeSeries.h"
+#include "util/Trace.h"
 
 int main(int argc, char* argv[])
 {
 	QApplication app(argc, argv);
 
-	//Read config file
-	QSettings config("config.ini", QSettings::IniFormat);
+	//Trace from startup when a trace output path is given
+	const QString tracePath = QString::fromLocal8Bit(qgetenv("CT_TRACE"));
+	Trace::setEnabled(!tracePath.isEmpty());
 
 	//Set application style
 	QApplication::setStyle(QStyleFactory::create("fusion"));
 
-	//Get volume dimensions from config
-	Volume::Dimensions dimensions;
+	//Load volume described by config file, a time series is shown starting at its first frame
+	VolumeSeries series;
+	Volume v;
+	QString error;
 
-	dimensions.sizeX = config.value("Application/sizeX", 0).toInt();
-	dimensions.sizeY = config.value("Application/sizeY", 0).toInt();
-	dimensions.sizeZ = config.value("Application/sizeZ", 0).toInt();
+	if (!series.open("config.ini", &error) || !series.frame(0, v, &error))
+	{
+		QMessageBox::critical(nullptr, "Volume loader error", error);
+		return -1;
+	}
 
-	Q_ASSERT(dimensions.sizeX != 0);
-	Q_ASSERT(dimensions.sizeY != 0);
-	Q_ASSERT(dimensions.sizeZ != 0);
+	series.resetStatistics();
+	
+	//Construct Volume viewer
+	MainWindow window(v, (series.frameCount() > 1) ? &series : nullptr);
 
-	dimensions.scaleX = config.value("Application/scaleX", 1).toInt();
-	dimensions.scaleY = config.value("Application/scaleY", 1).toInt();
-	dimensions.scaleZ = config.value("Application/scaleZ", 1).toInt();
+	//Configure render threads
+	QSettings config("config.ini", QSettings::IniFormat);
+	RenderThreadPool* pool = window.render()->threadPool();
 
-	//Try read volume data file
-	QFile file(config.value("Application/dataset").toString());
+	//Thread count includes the GUI thread, which takes part in drawing
+	const int threads = config.value("Render/threads", 0).toInt();
 
-	if (!file.open(QIODevice::ReadOnly))
+	if (threads > 0)
 	{
-		QMessageBox::critical(nullptr, "Volume loader error", file.errorString());
-		return -1;
+		pool->setWorkerCount(threads - 1);
+	}
+
+	QList<int> cpus;
+
+	for (const QString& cpu : config.value("Render/affinity").toStringList())
+	{
+		if (!cpu.trimmed().isEmpty())
+			cpus.append(cpu.toInt());
+	}
+
+	if (!cpus.isEmpty())
+	{
+		pool->setAffinity(cpus);
+	}
+
+	//Memory for transposed copies of the volume with contiguous X and Y slices
+	if (config.contains("Render/replicaMemory"))
+	{
+		window.render()->setReplicaBudget((quint64)config.value("Render/replicaMemory").toUInt() << 20);
+	}
+
+	//Optionally resample anisotropic volumes to isotropic voxels in the background from startup
+	ResampleKernel kernel;
+
+	if (VolumeResampler::parseKernel(config.value("Render/isotropic").toString(), kernel))
+	{
+		window.render()->setResampleKernel(kernel);
+		window.render()->enableIsotropic(true);
+	}
+
+	//Voxel order of the copy of the volume the 3D view samples
+	VolumeLayout layout;
+
+	if (LayoutVolume::parseLayout(config.value("Render/layout").toString(), layout))
+	{
+		window.render()->setLayout3D(layout);
 	}
-	
-	//Construct Volume
-	Volume v(file, dimensions);
-	
-	//Construct Volume viewer
-	MainWindow window(v);
 
 	//Move to center
 	QRect r = window.geometry();
@@ -59,5 +95,12 @@ int main(int argc, char* argv[])
 	//Show main window
 	window.show();
 
-	return app.exec();
+	const int result = app.exec();
+
+	if (!tracePath.isEmpty())
+	{
+		Trace::write(tracePath);
+	}
+
+	return result;
 }
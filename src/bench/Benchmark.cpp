@@ -0,0 +1,545 @@
+/*
+	Renderer benchmark
+
+	Times the drawing functions of VolumeRender on synthetic volumes, without a GUI or dataset.
+	Region growing is timed once per thread count, growing over the whole volume.
+	Filters are timed once per thread count, the pixels of a filter result are the voxels filtered.
+	Raycasting is also timed with the volume in linear, bricked and Morton order, with the camera turned
+	from looking along the Y axis (strided in memory) to looking along the X axis (contiguous in memory).
+
+	Every combination of volume type, thread count, output size, sampler and mapper is timed
+	and reported as CSV or JSON with pixel and sample throughput.
+
+	Example:
+		Benchmark --volumes phantom,spheres --size 256,256,128 --outputs 256,512 --threads 1,4,8 --format json
+*/
+
+#include <limits>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include "gfx/VolumeRender.h"
+#include "gfx/VolumeFilter.h"
+#include "SyntheticVolume.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Result of timing one configuration
+*/
+struct BenchmarkResult
+{
+	QString volume;
+	Volume::Dimensions dimensions;
+	int threads = 0;
+
+	QString function;
+	QString axis;
+	QString sampler;
+	QString mapper;
+
+	//Voxel layout and camera angle in degrees of layout comparisons
+	QString layout;
+	QString angle;
+
+	quint32 width = 0;
+	quint32 height = 0;
+
+	int iterations = 0;
+	double meanMs = 0.0;
+	double minMs = 0.0;
+
+	//Work done by a single draw call
+	quint64 pixels = 0;
+	quint64 samples = 0;
+	quint32 threadsUsed = 0;
+
+	double pixelsPerSecond() const { return (meanMs > 0.0) ? (pixels * 1000.0 / meanMs) : 0.0; }
+	double samplesPerSecond() const { return (meanMs > 0.0) ? (samples * 1000.0 / meanMs) : 0.0; }
+};
+
+/*
+	Benchmark options
+*/
+struct BenchmarkOptions
+{
+	QList<SyntheticVolumeType> volumes;
+	Volume::Dimensions dimensions;
+	QList<quint32> outputs;
+	QList<int> threads;
+	QList<VolumeAxis> axes;
+	QList<int> affinity;
+	int iterations = 5;
+	quint32 sampleFrequency = 125;
+	quint64 replicaBudget = VolumeRender::ReplicaBudgetDefault;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Helpers
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Parse a comma separated list of unsigned integers
+*/
+static bool parseList(const QString& text, QList<quint32>& values)
+{
+	values.clear();
+
+	for (const QString& item : text.split(',', QString::SkipEmptyParts))
+	{
+		bool ok = false;
+		const quint32 value = item.trimmed().toUInt(&ok);
+
+		if (!ok || value == 0)
+			return false;
+
+		values.append(value);
+	}
+
+	return !values.isEmpty();
+}
+
+/*
+	Time a draw function, filling in the mean and minimum time in milliseconds and the work done
+*/
+template<typename DrawFunc>
+static void timeDraw(const DrawFunc& draw, BenchmarkResult& result)
+{
+	//Warm up, also builds any lazily constructed data
+	draw();
+
+	double total = 0.0;
+	result.minMs = std::numeric_limits<double>::max();
+
+	for (int i = 0; i < result.iterations; i++)
+	{
+		const RenderStats stats = draw();
+		const double ms = stats.wallTimeMs();
+
+		total += ms;
+		result.minMs = std::min(result.minMs, ms);
+		result.samples = stats.samples;
+		result.threadsUsed = stats.threads;
+	}
+
+	result.meanMs = total / result.iterations;
+}
+
+/*
+	Camera transform used by the 3D view, optionally turned about the volume's Z axis by an angle in degrees
+*/
+static QMatrix4x4 cameraTransform(float angle = 0.0f)
+{
+	QMatrix4x4 view;
+	view.rotate(angle, 0, 0, 1);
+	view.rotate(90, 1, 0);
+
+	QMatrix4x4 scaling;
+	scaling.scale(1.4f, 1.4f, 1.4f);
+
+	return view * scaling;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Benchmark
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static QList<BenchmarkResult> run(const BenchmarkOptions& options, QTextStream& log)
+{
+	QList<BenchmarkResult> results;
+
+	const char* axisNames[] = { "x", "y", "z" };
+	const char* samplerNames[] = { "nearest", "bilinear", "bicubic" };
+	const char* sampler3DNames[] = { "nearest", "trilinear" };
+	const char* mapperNames[] = { "simple", "histogram", "adaptive" };
+
+	const QMatrix4x4 camera = cameraTransform();
+
+	for (SyntheticVolumeType type : options.volumes)
+	{
+		const QString volumeName = SyntheticVolume::typeNames()[type];
+
+		log << "Generating " << volumeName << " volume..." << endl;
+
+		Volume volume = SyntheticVolume::generate(type, options.dimensions);
+		VolumeRender render(volume);
+
+		//The renderer takes the voxels, the generated volume is left empty
+		const Volume& source = *render.volume();
+		render.setSampleFrequency(options.sampleFrequency);
+		render.setReplicaBudget(options.replicaBudget);
+		render.threadPool()->setAffinity(options.affinity);
+
+		for (int threads : options.threads)
+		{
+			//The thread calling a draw function takes part in drawing
+			render.threadPool()->setWorkerCount(threads - 1);
+
+			for (quint32 size : options.outputs)
+			{
+				ImageBuffer target(size, size, ImageBuffer::Gray8);
+
+				//Fill out common fields of a result
+				auto result = [&](const QString& function, const QString& axis, const QString& sampler, const QString& mapper) {
+					BenchmarkResult r;
+					r.volume = volumeName;
+					r.dimensions = options.dimensions;
+					r.threads = threads;
+					r.function = function;
+					r.axis = axis;
+					r.sampler = sampler;
+					r.mapper = mapper;
+					r.width = size;
+					r.height = size;
+					r.iterations = options.iterations;
+					r.pixels = (quint64)size * size;
+					return r;
+				};
+
+				log << volumeName << ": " << threads << " threads, " << size << "x" << size << endl;
+
+				/*
+					2D drawing functions
+				*/
+				for (int sampler = SamplingBasic; sampler <= SamplingBicubic; sampler++)
+				{
+					render.setSamplingType((SamplerType2D)sampler);
+
+					for (int mapper = 0; mapper < 3; mapper++)
+					{
+						render.enableHist(mapper == 1);
+						render.enableAdaptiveHist(mapper == 2);
+
+						for (VolumeAxis axis : options.axes)
+						{
+							const Volume::IndexType index = render.volume()->axisSize(axis) / 2;
+
+							BenchmarkResult slice = result("drawSubimage", axisNames[axis], samplerNames[sampler], mapperNames[mapper]);
+							timeDraw([&]() { return render.drawSubimage(target, index, axis); }, slice);
+							results.append(slice);
+
+							BenchmarkResult mip = result("drawSubimageMIP", axisNames[axis], samplerNames[sampler], mapperNames[mapper]);
+							timeDraw([&]() { return render.drawSubimageMIP(target, axis); }, mip);
+							results.append(mip);
+						}
+					}
+				}
+
+				render.enableHist(false);
+				render.enableAdaptiveHist(false);
+
+				/*
+					3D drawing functions, always use the simple mapper
+				*/
+				for (int sampler = SamplingBasic3D; sampler <= SamplingTrilinear; sampler++)
+				{
+					render.setSamplingType3D((SamplerType3D)sampler);
+
+					BenchmarkResult view = result("draw3D", "", sampler3DNames[sampler], mapperNames[0]);
+					timeDraw([&]() { return render.draw3D(target, camera); }, view);
+					results.append(view);
+
+					//Region of interest of one eighth of the volume, the work done should shrink with it
+					ClipRegion roi;
+					roi.setBox(AABB(QVector3D(0.25f, 0.25f, 0.25f), QVector3D(0.75f, 0.75f, 0.75f)));
+					render.setClipRegion(roi);
+
+					BenchmarkResult clipped = result("draw3DClipped", "", sampler3DNames[sampler], mapperNames[0]);
+					timeDraw([&]() { return render.draw3D(target, camera); }, clipped);
+					results.append(clipped);
+
+					render.setClipRegion(ClipRegion());
+
+					//Oblique plane through the volume centre, tilted off every axis
+					const ObliqueSlice plane = ObliqueSlice::centred(QVector3D(0.5f, 0.5f, 0.5f), QQuaternion::fromEulerAngles(30.0f, 20.0f, 10.0f));
+
+					BenchmarkResult oblique = result("drawOblique", "", sampler3DNames[sampler], mapperNames[0]);
+					timeDraw([&]() { return render.drawOblique(target, plane); }, oblique);
+					results.append(oblique);
+
+					//Raycasting in every voxel layout, the same image is drawn with different memory locality
+					for (int layout = LayoutLinear; layout <= LayoutMorton; layout++)
+					{
+						render.setLayout3D((VolumeLayout)layout);
+
+						for (float angle : { 0.0f, 30.0f, 45.0f, 60.0f, 90.0f })
+						{
+							const QMatrix4x4 turned = cameraTransform(angle);
+
+							BenchmarkResult march = result("draw3DLayout", "", sampler3DNames[sampler], mapperNames[0]);
+							march.layout = LayoutVolume::layoutNames()[layout];
+							march.angle = QString::number(angle);
+
+							timeDraw([&]() { return render.draw3D(target, turned); }, march);
+							results.append(march);
+						}
+					}
+
+					render.setLayout3D(LayoutLinear);
+				}
+			}
+
+			/*
+				Segmentation, the worst case of a region growing over the whole volume from its centre
+			*/
+			RegionGrowing::Options growOptions;
+			growOptions.lower = source.min();
+			growOptions.upper = source.max();
+
+			BenchmarkResult grow;
+			grow.volume = volumeName;
+			grow.dimensions = options.dimensions;
+			grow.threads = threads;
+			grow.function = "growRegion";
+			grow.sampler = "faces";
+			grow.iterations = options.iterations;
+
+			timeDraw([&]() {
+				return render.growRegion(source.sizeX() / 2, source.sizeY() / 2, source.sizeZ() / 2, growOptions);
+			}, grow);
+
+			grow.pixels = render.maskCount();
+			results.append(grow);
+
+			render.clearMask();
+
+			/*
+				Filters
+			*/
+			for (const QString& filterName : VolumeFilter::typeNames())
+			{
+				VolumeFilter::Options filterOptions;
+				VolumeFilter::parseType(filterName, filterOptions.type);
+
+				BenchmarkResult filter;
+				filter.volume = volumeName;
+				filter.dimensions = options.dimensions;
+				filter.threads = threads;
+				filter.function = "filter";
+				filter.sampler = filterName;
+				filter.iterations = options.iterations;
+				filter.pixels = (quint64)source.sizeX() * source.sizeY() * source.sizeZ();
+
+				timeDraw([&]() {
+					QElapsedTimer timer;
+					timer.start();
+
+					RenderCounters counters;
+					VolumeFilter::apply(source, filterOptions, &counters, render.threadPool(), PriorityInteractive);
+
+					return counters.stats(timer.nsecsElapsed());
+				}, filter);
+
+				results.append(filter);
+			}
+		}
+	}
+
+	return results;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Output
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void writeCSV(QTextStream& out, const QList<BenchmarkResult>& results)
+{
+	out << "volume,sizeX,sizeY,sizeZ,threads,function,axis,sampler,mapper,width,height,iterations,mean_ms,min_ms,pixels,samples,threads_used,pixels_per_s,samples_per_s,layout,angle" << endl;
+
+	for (const BenchmarkResult& r : results)
+	{
+		out << r.volume << ','
+			<< r.dimensions.sizeX << ',' << r.dimensions.sizeY << ',' << r.dimensions.sizeZ << ','
+			<< r.threads << ','
+			<< r.function << ',' << r.axis << ',' << r.sampler << ',' << r.mapper << ','
+			<< r.width << ',' << r.height << ','
+			<< r.iterations << ','
+			<< r.meanMs << ',' << r.minMs << ','
+			<< r.pixels << ',' << r.samples << ',' << r.threadsUsed << ','
+			<< r.pixelsPerSecond() << ',' << r.samplesPerSecond() << ','
+			<< r.layout << ',' << r.angle << endl;
+	}
+}
+
+static void writeJSON(QTextStream& out, const QList<BenchmarkResult>& results)
+{
+	QJsonArray array;
+
+	for (const BenchmarkResult& r : results)
+	{
+		QJsonObject obj;
+		obj["volume"] = r.volume;
+		obj["size"] = QJsonArray({ (int)r.dimensions.sizeX, (int)r.dimensions.sizeY, (int)r.dimensions.sizeZ });
+		obj["threads"] = r.threads;
+		obj["function"] = r.function;
+		obj["axis"] = r.axis;
+		obj["sampler"] = r.sampler;
+		obj["mapper"] = r.mapper;
+		obj["width"] = (int)r.width;
+		obj["height"] = (int)r.height;
+		obj["iterations"] = r.iterations;
+		obj["mean_ms"] = r.meanMs;
+		obj["min_ms"] = r.minMs;
+		obj["pixels"] = (double)r.pixels;
+		obj["samples"] = (double)r.samples;
+		obj["threads_used"] = (int)r.threadsUsed;
+		obj["pixels_per_s"] = r.pixelsPerSecond();
+		obj["samples_per_s"] = r.samplesPerSecond();
+		obj["layout"] = r.layout;
+		obj["angle"] = r.angle;
+		array.append(obj);
+	}
+
+	out << QJsonDocument(array).toJson();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("Benchmark");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Headless volume renderer benchmark using synthetic volumes");
+	parser.addHelpOption();
+
+	QCommandLineOption volumesOption("volumes", "Comma separated volume types: " + SyntheticVolume::typeNames().join(','), "types", "phantom");
+	QCommandLineOption sizeOption("size", "Volume size as X,Y,Z.", "size", "256,256,128");
+	QCommandLineOption outputsOption("outputs", "Comma separated output image sizes.", "sizes", "256,512");
+	QCommandLineOption threadsOption("threads", "Comma separated thread counts.", "counts", QString("1,%1").arg(QThread::idealThreadCount()));
+	QCommandLineOption axesOption("axes", "Comma separated subimage axes (x,y,z).", "axes", "z");
+	QCommandLineOption iterationsOption("iterations", "Timed iterations per configuration.", "count", "5");
+	QCommandLineOption affinityOption("affinity", "Comma separated CPUs to pin render threads to.", "cpus");
+	QCommandLineOption frequencyOption("frequency", "Raycast sample frequency.", "frequency", "125");
+	QCommandLineOption replicaOption("replica-memory", "Memory in MB for X and Y slice replicas, 0 draws every axis from the volume.", "mb", QString::number(VolumeRender::ReplicaBudgetDefault >> 20));
+	QCommandLineOption formatOption("format", "Output format (csv or json).", "format", "csv");
+	QCommandLineOption outputOption("output", "Output file, defaults to standard output.", "file");
+
+	parser.addOptions({ volumesOption, sizeOption, outputsOption, threadsOption, axesOption, iterationsOption, affinityOption, frequencyOption, replicaOption, formatOption, outputOption });
+	parser.process(app);
+
+	QTextStream log(stderr);
+	BenchmarkOptions options;
+
+	//Volume types
+	for (const QString& name : parser.value(volumesOption).split(',', QString::SkipEmptyParts))
+	{
+		SyntheticVolumeType type;
+
+		if (!SyntheticVolume::parseType(name.trimmed(), type))
+		{
+			log << "Unknown volume type: " << name << endl;
+			return 1;
+		}
+
+		options.volumes.append(type);
+	}
+
+	//Volume size
+	QList<quint32> size;
+
+	if (!parseList(parser.value(sizeOption), size) || size.size() != 3)
+	{
+		log << "Invalid volume size: " << parser.value(sizeOption) << endl;
+		return 1;
+	}
+
+	options.dimensions = Volume::Dimensions(size[0], size[1], size[2], 1, 1, 1);
+
+	//Output sizes
+	if (!parseList(parser.value(outputsOption), options.outputs))
+	{
+		log << "Invalid output sizes: " << parser.value(outputsOption) << endl;
+		return 1;
+	}
+
+	//Thread counts
+	QList<quint32> threads;
+
+	if (!parseList(parser.value(threadsOption), threads))
+	{
+		log << "Invalid thread counts: " << parser.value(threadsOption) << endl;
+		return 1;
+	}
+
+	for (quint32 count : threads)
+	{
+		options.threads.append((int)count);
+	}
+
+	//Axes
+	for (const QString& name : parser.value(axesOption).split(',', QString::SkipEmptyParts))
+	{
+		const int axis = QStringList({ "x", "y", "z" }).indexOf(name.trimmed().toLower());
+
+		if (axis < 0)
+		{
+			log << "Unknown axis: " << name << endl;
+			return 1;
+		}
+
+		options.axes.append((VolumeAxis)axis);
+	}
+
+	options.iterations = std::max(parser.value(iterationsOption).toInt(), 1);
+	options.sampleFrequency = std::max(parser.value(frequencyOption).toUInt(), 1u);
+	options.replicaBudget = (quint64)parser.value(replicaOption).toUInt() << 20;
+
+	//CPU affinity
+	for (const QString& cpu : parser.value(affinityOption).split(',', QString::SkipEmptyParts))
+	{
+		options.affinity.append(cpu.trimmed().toInt());
+	}
+
+	const QString format = parser.value(formatOption).toLower();
+
+	if (format != "csv" && format != "json")
+	{
+		log << "Unknown output format: " << format << endl;
+		return 1;
+	}
+
+	//Open output
+	QFile file;
+
+	if (parser.isSet(outputOption))
+	{
+		file.setFileName(parser.value(outputOption));
+
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			log << "Unable to open output file: " << file.errorString() << endl;
+			return 1;
+		}
+	}
+	else
+	{
+		file.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+	}
+
+	const QList<BenchmarkResult> results = run(options, log);
+
+	QTextStream out(&file);
+
+	if (format == "json")
+	{
+		writeJSON(out, results);
+	}
+	else
+	{
+		writeCSV(out, results);
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
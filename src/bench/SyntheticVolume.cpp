@@ -0,0 +1,170 @@
+/*
+	Synthetic volume generator source
+*/
+
+#include <random>
+
+#include <QtConcurrentMap>
+
+#include "SyntheticVolume.h"
+#include "util/CountingIterator.h"
+
+/*
+	Intensity range of generated voxels, similar to CT data
+*/
+enum Intensities
+{
+	AIR = 0,
+	SOFT_TISSUE = 1100,
+	BONE = 2800,
+	MAX_INTENSITY = 3200
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Ellipsoid in normalized volume coordinates
+*/
+struct Ellipsoid
+{
+	float cx, cy, cz;
+	float rx, ry, rz;
+	Volume::ElementType value;
+
+	bool contains(float x, float y, float z) const
+	{
+		const float dx = (x - cx) / rx;
+		const float dy = (y - cy) / ry;
+		const float dz = (z - cz) / rz;
+		return (dx*dx + dy*dy + dz*dz) <= 1.0f;
+	}
+};
+
+/*
+	Fill every voxel of a volume with a value computed from normalized coordinates
+*/
+template<typename VoxelFunc>
+static Volume fill(const Volume::Dimensions& dim, const VoxelFunc& voxel)
+{
+	QVector<Volume::ElementType> data(dim.sizeX * dim.sizeY * dim.sizeZ);
+	Volume::ElementType* dst = data.data();
+
+	//Slices are generated concurrently
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(dim.sizeZ), [&](size_t z) {
+
+		Volume::ElementType* slice = dst + (z * dim.sizeX * dim.sizeY);
+
+		for (Volume::IndexType y = 0; y < dim.sizeY; y++)
+		{
+			for (Volume::IndexType x = 0; x < dim.sizeX; x++)
+			{
+				slice[x + (y * dim.sizeX)] = voxel(
+					((float)x + 0.5f) / dim.sizeX,
+					((float)y + 0.5f) / dim.sizeY,
+					((float)z + 0.5f) / dim.sizeZ
+				);
+			}
+		}
+	});
+
+	return Volume(dim, std::move(data));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Volume SyntheticVolume::generate(SyntheticVolumeType type, const Volume::Dimensions& dimensions, quint32 seed)
+{
+	std::mt19937 rng(seed);
+
+	switch (type)
+	{
+	case SyntheticPhantom:
+	{
+		//Outer to inner, later ellipsoids override earlier ones
+		const Ellipsoid shapes[] =
+		{
+			{ 0.50f, 0.50f, 0.50f, 0.42f, 0.46f, 0.44f, BONE },        //skull
+			{ 0.50f, 0.50f, 0.50f, 0.38f, 0.42f, 0.40f, SOFT_TISSUE }, //brain
+			{ 0.40f, 0.45f, 0.50f, 0.06f, 0.16f, 0.10f, SOFT_TISSUE - 300 }, //ventricles
+			{ 0.60f, 0.45f, 0.50f, 0.06f, 0.16f, 0.10f, SOFT_TISSUE - 300 },
+			{ 0.50f, 0.30f, 0.55f, 0.05f, 0.05f, 0.05f, SOFT_TISSUE + 400 }, //lesions
+			{ 0.45f, 0.70f, 0.40f, 0.03f, 0.03f, 0.06f, SOFT_TISSUE + 600 },
+		};
+
+		return fill(dimensions, [&](float x, float y, float z) {
+
+			Volume::ElementType value = AIR;
+
+			for (const Ellipsoid& e : shapes)
+			{
+				if (e.contains(x, y, z))
+					value = e.value;
+			}
+
+			return value;
+		});
+	}
+	case SyntheticNoise:
+	{
+		//Generate voxels sequentially so the result only depends on the seed
+		QVector<Volume::ElementType> data(dimensions.sizeX * dimensions.sizeY * dimensions.sizeZ);
+		std::uniform_int_distribution<int> dist(AIR, MAX_INTENSITY);
+
+		for (Volume::ElementType& voxel : data)
+		{
+			voxel = (Volume::ElementType)dist(rng);
+		}
+
+		return Volume(dimensions, std::move(data));
+	}
+	case SyntheticSpheres:
+	{
+		std::uniform_real_distribution<float> position(0.1f, 0.9f);
+		std::uniform_real_distribution<float> radius(0.02f, 0.12f);
+		std::uniform_int_distribution<int> intensity(SOFT_TISSUE, MAX_INTENSITY);
+
+		QVector<Ellipsoid> spheres;
+
+		for (int i = 0; i < 32; i++)
+		{
+			const float r = radius(rng);
+			const float cx = position(rng), cy = position(rng), cz = position(rng);
+			spheres.append(Ellipsoid{ cx, cy, cz, r, r, r, (Volume::ElementType)intensity(rng) });
+		}
+
+		return fill(dimensions, [&](float x, float y, float z) {
+
+			Volume::ElementType value = AIR;
+
+			for (const Ellipsoid& e : spheres)
+			{
+				if (e.contains(x, y, z))
+					value = std::max(value, e.value);
+			}
+
+			return value;
+		});
+	}
+	}
+
+	Q_UNREACHABLE();
+	return Volume();
+}
+
+QStringList SyntheticVolume::typeNames()
+{
+	return { "phantom", "noise", "spheres" };
+}
+
+bool SyntheticVolume::parseType(const QString& name, SyntheticVolumeType& type)
+{
+	const int index = typeNames().indexOf(name.toLower());
+
+	if (index < 0)
+		return false;
+
+	type = (SyntheticVolumeType)index;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,50 @@
+/*
+	Synthetic volume generator
+
+	Generates volumes of arbitrary size for benchmarking, without needing a dataset.
+
+	Phantom:
+		Head-like phantom of nested ellipsoids (skull, soft tissue and a few inner structures)
+
+	Noise:
+		Uniformly distributed random voxels
+
+	Spheres:
+		Randomly placed spheres of random intensity
+*/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "gfx/Volume.h"
+
+enum SyntheticVolumeType
+{
+	SyntheticPhantom,
+	SyntheticNoise,
+	SyntheticSpheres
+};
+
+class SyntheticVolume
+{
+public:
+
+	/*
+		Generate a volume of a given type and size.
+
+		The seed makes random volumes reproducible.
+	*/
+	static Volume generate(SyntheticVolumeType type, const Volume::Dimensions& dimensions, quint32 seed = 1);
+
+	/*
+		Names of volume types, indexed by type
+	*/
+	static QStringList typeNames();
+
+	/*
+		Parse a volume type from its name, returns false if the name is unknown
+	*/
+	static bool parseType(const QString& name, SyntheticVolumeType& type);
+};
@@ -0,0 +1,84 @@
+/*
+	Clip region class
+
+	Region of interest of a volume in normalized volume coordinates: a box, optionally cut by a set of planes.
+	A point is inside the region if it is inside the box and on the positive side of every plane.
+
+	Drawing functions narrow their ray intervals and slice ranges to the region,
+	so the work done is proportional to its size.
+*/
+
+#pragma once
+
+#include "RayCasting.h"
+
+class ClipRegion
+{
+public:
+
+	/*
+		Construct a region covering the whole volume
+	*/
+	ClipRegion() :
+		m_box(QVector3D(0.0f, 0.0f, 0.0f), QVector3D(1.0f, 1.0f, 1.0f))
+	{}
+
+	/*
+		Box, clamped to the volume
+	*/
+	const AABB& box() const { return m_box; }
+
+	void setBox(const AABB& box)
+	{
+		const QVector3D zero(0.0f, 0.0f, 0.0f);
+		const QVector3D one(1.0f, 1.0f, 1.0f);
+
+		m_box.min = clamp(box.min, zero, one);
+		m_box.max = clamp(box.max, m_box.min, one);
+	}
+
+	/*
+		Clip planes
+	*/
+	const QVector<Plane>& planes() const { return m_planes; }
+
+	void addPlane(const Plane& plane) { m_planes.append(plane); }
+	void clearPlanes() { m_planes.clear(); }
+
+	/*
+		True if the region covers the whole volume
+	*/
+	bool isWholeVolume() const
+	{
+		return m_planes.isEmpty() && m_box.min == QVector3D(0.0f, 0.0f, 0.0f) && m_box.max == QVector3D(1.0f, 1.0f, 1.0f);
+	}
+
+	/*
+		Narrow an interval of distances along a ray to the region, returns false if nothing is left
+	*/
+	bool clip(const Ray& ray, float& t0, float& t1) const
+	{
+		return Raycast::clip(m_box, m_planes, ray, t0, t1);
+	}
+
+	bool operator==(const ClipRegion& other) const
+	{
+		return m_box.min == other.m_box.min && m_box.max == other.m_box.max && m_planes == other.m_planes;
+	}
+
+	bool operator!=(const ClipRegion& other) const { return !(*this == other); }
+
+private:
+
+	static QVector3D clamp(const QVector3D& v, const QVector3D& lo, const QVector3D& hi)
+	{
+		return QVector3D(
+			std::max(lo.x(), std::min(v.x(), hi.x())),
+			std::max(lo.y(), std::min(v.y(), hi.y())),
+			std::max(lo.z(), std::min(v.z(), hi.z()))
+		);
+	}
+
+	AABB m_box;
+	QVector<Plane> m_planes;
+};
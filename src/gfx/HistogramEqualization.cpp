@@ -4,13 +4,19 @@
 
 #include <algorithm>
 
+#include <QtConcurrentMap>
+
 #include "HistogramEqualization.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HistogramEqualizer::HistogramEqualizer(const Volume* volume) :
 	MappingTable(volume)
 {
+	TRACE_SCOPE("buildHistogram");
+
 	Q_ASSERT(volume != nullptr);
 
 	const Volume::SizeType levels = (m_volume->max() - m_volume->min()) + 1;
@@ -61,3 +67,93 @@ SimpleEqualizer::SimpleEqualizer(const Volume* volume) :
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+AdaptiveEqualizer::AdaptiveEqualizer(const Volume* volume, Volume::SizeType tilesX, Volume::SizeType tilesY, Volume::SizeType tilesZ, float clipLimit) :
+	m_volume(volume)
+{
+	TRACE_SCOPE("buildAdaptiveHistogram");
+
+	Q_ASSERT(volume != nullptr);
+
+	//A tile must contain at least one voxel along every axis
+	m_tilesX = std::max(std::min(tilesX, volume->sizeX()), 1u);
+	m_tilesY = std::max(std::min(tilesY, volume->sizeY()), 1u);
+	m_tilesZ = std::max(std::min(tilesZ, volume->sizeZ()), 1u);
+
+	m_levels = (m_volume->max() - m_volume->min()) + 1;
+
+	const Volume::SizeType tileCount = m_tilesX * m_tilesY * m_tilesZ;
+
+	m_mapping.resize((int)(tileCount * m_levels));
+
+	quint8* tables = m_mapping.data();
+
+	//Tiles are independent so their tables can be computed concurrently
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(tileCount), [&](size_t tile) {
+		buildTile((Volume::IndexType)tile, clipLimit, tables + (tile * m_levels));
+	});
+}
+
+void AdaptiveEqualizer::buildTile(Volume::IndexType tile, float clipLimit, quint8* mapping)
+{
+	TRACE_SCOPE_ARG("buildTile", tile);
+
+	//Tile coordinates in grid
+	const Volume::IndexType tx = tile % m_tilesX;
+	const Volume::IndexType ty = (tile / m_tilesX) % m_tilesY;
+	const Volume::IndexType tz = tile / (m_tilesX * m_tilesY);
+
+	//Voxel range covered by tile
+	const Volume::IndexType x0 = (tx * m_volume->sizeX()) / m_tilesX, x1 = ((tx + 1) * m_volume->sizeX()) / m_tilesX;
+	const Volume::IndexType y0 = (ty * m_volume->sizeY()) / m_tilesY, y1 = ((ty + 1) * m_volume->sizeY()) / m_tilesY;
+	const Volume::IndexType z0 = (tz * m_volume->sizeZ()) / m_tilesZ, z1 = ((tz + 1) * m_volume->sizeZ()) / m_tilesZ;
+
+	const Volume::SizeType size = (x1 - x0) * (y1 - y0) * (z1 - z0);
+
+	//Frequency histogram of tile
+	QVector<Volume::SizeType> frequencyHistogram((int)m_levels);
+
+	for (Volume::IndexType z = z0; z < z1; z++)
+	{
+		for (Volume::IndexType y = y0; y < y1; y++)
+		{
+			for (Volume::IndexType x = x0; x < x1; x++)
+			{
+				frequencyHistogram[m_volume->at(x, y, z) - m_volume->min()]++;
+			}
+		}
+	}
+
+	//Clip histogram and count the excess
+	const Volume::SizeType limit = std::max((Volume::SizeType)(clipLimit * size / m_levels), 1u);
+	Volume::SizeType excess = 0;
+
+	for (Volume::SizeType& bin : frequencyHistogram)
+	{
+		if (bin > limit)
+		{
+			excess += bin - limit;
+			bin = limit;
+		}
+	}
+
+	//Redistribute excess evenly over all bins
+	const Volume::SizeType increment = excess / m_levels;
+	const Volume::SizeType remainder = excess % m_levels;
+
+	for (Volume::SizeType i = 0; i < m_levels; i++)
+	{
+		frequencyHistogram[i] += increment + ((i < remainder) ? 1 : 0);
+	}
+
+	//Compute mapping from cumulative distribution function
+	Volume::SizeType tfunction = 0;
+
+	for (Volume::SizeType i = 0; i < m_levels; i++)
+	{
+		tfunction += frequencyHistogram[i];
+		mapping[i] = (quint8)(255.0f * ((float)tfunction / size));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -6,8 +6,13 @@
 
 	SimpleEqualizer:
 		Uses simplest equalizer method
+
+	AdaptiveEqualizer:
+		Stores/computes contrast limited adaptive histogram equalization (CLAHE) tables for a grid of tiles
 */
 
+#pragma once
+
 #include "Volume.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,6 +47,15 @@ public:
 		);
 	}
 
+	/*
+		Map the voxels of another volume with the same value range, such as a later frame of a series
+	*/
+	void rebind(const Volume* volume)
+	{
+		Q_ASSERT(volume->min() == m_volume->min() && volume->max() == m_volume->max());
+		m_volume = volume;
+	}
+
 protected:
 
 	const Volume* m_volume;
@@ -77,3 +91,112 @@ public:
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Contrast limited adaptive histogram equalization class
+
+	The volume is divided into a 3D grid of tiles, each with its own clipped equalization table.
+	A voxel is mapped by blending the tables of the tiles surrounding it, so for any given slice
+	the result is a bilinear blend between neighbouring tiles in the plane (and a linear blend between tile layers).
+*/
+class AdaptiveEqualizer
+{
+public:
+
+	/*
+		Construct the tile tables for a given volume.
+
+		The clip limit is a multiple of the average bin height of a tile histogram.
+	*/
+	AdaptiveEqualizer(
+		const Volume* volume,
+		Volume::SizeType tilesX = 8,
+		Volume::SizeType tilesY = 8,
+		Volume::SizeType tilesZ = 4,
+		float clipLimit = 3.0f
+	);
+
+	/*
+		Map a voxel to an 8bit value
+
+		u/v/w are the normalized coordinates of the voxel within the volume
+	*/
+	quint8 normalize(Volume::ElementType value, float u, float v, float w) const
+	{
+		//Index into tile tables
+		const Volume::IndexType level = (Volume::IndexType)std::min(
+			std::max(value - m_volume->min(), 0),
+			m_volume->max() - m_volume->min()
+		);
+
+		Volume::IndexType x[2], y[2], z[2];
+		float fx, fy, fz;
+
+		neighbours(u, m_tilesX, x, fx);
+		neighbours(v, m_tilesY, y, fy);
+		neighbours(w, m_tilesZ, z, fz);
+
+		//Blend tables of the 8 surrounding tiles
+		float layers[2];
+
+		for (int k = 0; k < 2; k++)
+		{
+			const float top    = lerp(lookup(x[0], y[0], z[k], level), lookup(x[1], y[0], z[k], level), fx);
+			const float bottom = lerp(lookup(x[0], y[1], z[k], level), lookup(x[1], y[1], z[k], level), fx);
+			layers[k] = lerp(top, bottom, fy);
+		}
+
+		return (quint8)(lerp(layers[0], layers[1], fz) + 0.5f);
+	}
+
+	/*
+		Map the voxels of another volume with the same value range, such as a later frame of a series
+	*/
+	void rebind(const Volume* volume)
+	{
+		Q_ASSERT(volume->min() == m_volume->min() && volume->max() == m_volume->max());
+		m_volume = volume;
+	}
+
+	/*
+		Tile grid dimensions
+	*/
+	Volume::SizeType tilesX() const { return m_tilesX; }
+	Volume::SizeType tilesY() const { return m_tilesY; }
+	Volume::SizeType tilesZ() const { return m_tilesZ; }
+
+private:
+
+	//Compute the two tiles whose centres surround a normalized coordinate, and the weight between them
+	static void neighbours(float coord, Volume::SizeType tiles, Volume::IndexType idx[2], float& weight)
+	{
+		const float f = std::min(std::max(coord * tiles - 0.5f, 0.0f), (float)(tiles - 1));
+		idx[0] = (Volume::IndexType)f;
+		idx[1] = std::min(idx[0] + 1, tiles - 1);
+		weight = f - idx[0];
+	}
+
+	static float lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+	//Fetch a mapped value from the table of a given tile
+	float lookup(Volume::IndexType tx, Volume::IndexType ty, Volume::IndexType tz, Volume::IndexType level) const
+	{
+		const Volume::IndexType tile = tx + m_tilesX * (ty + m_tilesY * tz);
+		return m_mapping[(int)(tile * m_levels + level)];
+	}
+
+	//Build the table of a single tile
+	void buildTile(Volume::IndexType tile, float clipLimit, quint8* mapping);
+
+	const Volume* m_volume;
+
+	Volume::SizeType m_tilesX;
+	Volume::SizeType m_tilesY;
+	Volume::SizeType m_tilesZ;
+	Volume::SizeType m_levels;
+
+	//Tables for every tile, stored contiguously
+	QVector<quint8> m_mapping;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
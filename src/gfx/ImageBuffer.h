@@ -1,7 +1,10 @@
 /*
 	Image buffer class:
 
-	Represents an 8bit grey scale image.
+	Represents an 8bit grey scale or 32bit colour image.
+
+	Rows are padded to a fixed alignment and the storage itself is aligned,
+	so every scanline starts on an aligned address.
 */
 
 #pragma once
@@ -17,68 +20,159 @@ public:
 	using SizeType = quint32;
 	using IndexType = quint32;
 
+	/*
+		Pixel formats
+	*/
+	enum Format
+	{
+		Gray8, //8 bit grey scale
+		RGBA8  //32 bit colour, stored as QRgb
+	};
+
+	//Alignment of storage and row pitch in bytes
+	static const SizeType Alignment = 64;
+
 	ImageBuffer() {}
 
 	/*
 		Construct image buffer with reserved size
 	*/
-	ImageBuffer(SizeType width, SizeType height)
+	ImageBuffer(SizeType width, SizeType height, Format format = Gray8)
 	{
-		this->realloc(width, height);
+		this->realloc(width, height, format);
+	}
+
+	//Moveable
+	ImageBuffer(ImageBuffer&& other)
+	{
+		swap(other);
+	}
+
+	ImageBuffer& operator=(ImageBuffer&& other)
+	{
+		swap(other);
+		return *this;
+	}
+
+	~ImageBuffer()
+	{
+		qFreeAligned(m_image);
 	}
 
 	/*
 		Fetch a pixel at the given coordinates
 	*/
-	ElementType& at(IndexType u, IndexType v)
+	template<typename PixelType>
+	PixelType& pixel(IndexType u, IndexType v)
 	{
+		Q_ASSERT(sizeof(PixelType) == bytesPerPixel());
 		Q_ASSERT(u < m_width);
-		Q_ASSERT(v < m_height);
-		return m_image[(int)((v * m_width) + u)];
+		return reinterpret_cast<PixelType*>(scanLine(v))[u];
 	}
 
-	ElementType at(IndexType u, IndexType v) const
+	template<typename PixelType>
+	PixelType pixel(IndexType u, IndexType v) const
 	{
+		Q_ASSERT(sizeof(PixelType) == bytesPerPixel());
 		Q_ASSERT(u < m_width);
+		return reinterpret_cast<const PixelType*>(scanLine(v))[u];
+	}
+
+	/*
+		Fetch a grey scale pixel at the given coordinates
+	*/
+	ElementType& at(IndexType u, IndexType v) { return pixel<ElementType>(u, v); }
+	ElementType at(IndexType u, IndexType v) const { return pixel<ElementType>(u, v); }
+
+	/*
+		Fetch pointer to the start of a row
+	*/
+	ElementType* scanLine(IndexType v)
+	{
+		Q_ASSERT(v < m_height);
+		return m_image + ((size_t)v * m_pitch);
+	}
+
+	const ElementType* scanLine(IndexType v) const
+	{
 		Q_ASSERT(v < m_height);
-		return m_image[(int)((v * m_width) + u)];
+		return m_image + ((size_t)v * m_pitch);
 	}
 
 	/*
-		Change size of buffer.
+		Change size/format of buffer.
 
 		Old content may be discarded.
 	*/
-	ImageBuffer& realloc(SizeType width, SizeType height)
+	ImageBuffer& realloc(SizeType width, SizeType height, Format format)
 	{
+		m_format = format;
+		m_width = width;
+		m_height = height;
+
+		//Round row size up to alignment
+		m_pitch = ((width * bytesPerPixel()) + (Alignment - 1)) & ~(Alignment - 1);
+
+		const size_t size = (size_t)m_pitch * height;
+
 		//Increase buffer size if necessary
-		if ((width * height) > (m_width * m_height))
+		if (size > m_capacity)
 		{
-			m_image.resize((int)width * (int)height);
+			qFreeAligned(m_image);
+			m_image = (ElementType*)qMallocAligned(size, Alignment);
+			m_capacity = size;
 		}
 
-		m_width = width;
-		m_height = height;
-
 		return *this;
 	}
 
+	ImageBuffer& realloc(SizeType width, SizeType height)
+	{
+		return realloc(width, height, m_format);
+	}
+
 	/*
 		Buffer dimensions
 	*/
 	SizeType width() const { return m_width; }
 	SizeType height() const { return m_height; }
 
+	//Row size in bytes, including padding
+	SizeType pitch() const { return m_pitch; }
+
+	/*
+		Pixel format
+	*/
+	Format format() const { return m_format; }
+	SizeType bytesPerPixel() const { return (m_format == RGBA8) ? 4 : 1; }
+
+	/*
+		Exchange contents with another buffer
+	*/
+	void swap(ImageBuffer& other)
+	{
+		std::swap(m_width, other.m_width);
+		std::swap(m_height, other.m_height);
+		std::swap(m_pitch, other.m_pitch);
+		std::swap(m_format, other.m_format);
+		std::swap(m_capacity, other.m_capacity);
+		std::swap(m_image, other.m_image);
+	}
+
 	/*
 		Convert to image
+
+		The image references the buffer memory directly, no copy is made.
+		It is only valid for as long as the buffer is not reallocated or destroyed.
 	*/
 	QImage toImage() const
 	{
 		return QImage(
-			(const uchar*)m_image.data(),
+			(const uchar*)m_image,
 			(int)m_width,
-			(int)m_height, (int)m_width,
-			QImage::Format_Grayscale8
+			(int)m_height,
+			(int)m_pitch,
+			(m_format == RGBA8) ? QImage::Format_ARGB32 : QImage::Format_Grayscale8
 		);
 	}
 
@@ -92,7 +186,49 @@ public:
 
 private:
 
+	Q_DISABLE_COPY(ImageBuffer)
+
 	SizeType m_width = 0;
 	SizeType m_height = 0;
-	QVector<ElementType> m_image; //data
+	SizeType m_pitch = 0;
+	Format m_format = Gray8;
+
+	size_t m_capacity = 0;
+	ElementType* m_image = nullptr; //data
+};
+
+/*
+	Double buffered image:
+
+	Frames are drawn into the back buffer, then swapped to the front to be presented.
+	The front buffer is handed to a widget without copying while the next frame is drawn into the back buffer.
+*/
+class ImageSwapChain
+{
+public:
+
+	ImageSwapChain() {}
+
+	/*
+		Buffer being drawn into
+	*/
+	ImageBuffer& back() { return m_buffers[m_back]; }
+
+	/*
+		Last completed frame, may be drawn into to complete parts of it
+	*/
+	ImageBuffer& front() { return m_buffers[1 - m_back]; }
+	const ImageBuffer& front() const { return m_buffers[1 - m_back]; }
+
+	/*
+		Make the back buffer the new front buffer
+	*/
+	void swap() { m_back = 1 - m_back; }
+
+private:
+
+	Q_DISABLE_COPY(ImageSwapChain)
+
+	ImageBuffer m_buffers[2];
+	int m_back = 0;
 };
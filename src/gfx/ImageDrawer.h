@@ -3,55 +3,164 @@
 */
 #pragma once
 
+#include <type_traits>
+
+#include <QRect>
 #include <QtConcurrentMap>
 
 #include "util/CountingIterator.h"
+#include "util/Trace.h"
 #include "ImageBuffer.h"
+#include "Samplers.h"
+#include "RenderStatistics.h"
+#include "RenderThreadPool.h"
 
 class ImageDrawer
 {
 public:
 
+	/*
+		Record work done by the pixel function currently executing on this thread.
+
+		Counts are gathered per row and added to the counters passed to dispatch.
+	*/
+	static void countSamples(quint64 n) { local().samples += n; }
+	static void countSkipped(quint64 n) { local().skipped += n; }
+
 	/*
 		Apply a given pixel function for every pixel in a target image.
 
 		A pixel function in this case is analagous to a pixel/fragment shader:
 		The input is the normalized texture coordinates of the destination pixel.
-		The output is an 8 bit colour value.
+		The output is a pixel value matching the format of the target (quint8 for Gray8, QRgb for RGBA8).
+
+		Optionally the work done is added to a set of counters.
+
+		Rows are drawn on the given thread pool at the given priority,
+		or on QtConcurrent's global pool if no pool is given.
+
+		Optionally only a region of the target is drawn, texture coordinates remain relative to the whole target.
 	*/
 	template<typename PixelFunc>
-	static void dispatch(ImageBuffer& target, const PixelFunc& pixel)
+	static void dispatch(
+		ImageBuffer& target,
+		const PixelFunc& pixel,
+		RenderCounters* counters = nullptr,
+		RenderThreadPool* pool = nullptr,
+		RenderPriority priority = PriorityInteractive,
+		const QRect& region = QRect()
+	)
 	{
-		//Per-pixel procedure
-		auto proc = [&](size_t n) {
+		using PixelType = typename std::decay<decltype(pixel(UV()))>::type;
 
-			//Get coordinates from counting value
-			const quint32 i = (quint32)n % target.width();
-			const quint32 j = (quint32)n / target.width();
+		dispatchRows<PixelType>(target, [&](PixelType* row, quint32 j, quint32 begin, quint32 end) {
 
 			//Normalized texture coordinates
-			const auto u = (float)i / target.width();
 			const auto v = (float)j / target.height();
 
-			//Apply function and store result
-			target.at(i, j) = pixel(UV(u, v));
+			for (quint32 i = begin; i < end; i++)
+			{
+				const auto u = (float)i / target.width();
+
+				//Apply function and store result
+				row[i] = pixel(UV(u, v));
+			}
+
+		}, counters, pool, priority, region);
+	}
+
+	/*
+		Apply a given row function for every row in a target image.
+
+		Row functions draw a span of pixels at once, so state can be carried from one pixel to the next:
+		The input is a pointer to the destination row, the row index and the half open range of columns to draw.
+		Pixels of the row are of the given PixelType, matching the format of the target.
+
+		Counters, thread pool, priority and region behave as in dispatch.
+	*/
+	template<typename PixelType, typename RowFunc>
+	static void dispatchRows(
+		ImageBuffer& target,
+		const RowFunc& rowFunc,
+		RenderCounters* counters = nullptr,
+		RenderThreadPool* pool = nullptr,
+		RenderPriority priority = PriorityInteractive,
+		const QRect& region = QRect()
+	)
+	{
+		Q_ASSERT(sizeof(PixelType) == target.bytesPerPixel());
+
+		//Pixels to draw
+		const QRect bounds(0, 0, (int)target.width(), (int)target.height());
+		const QRect area = region.isNull() ? bounds : (region & bounds);
+
+		if (area.isEmpty())
+			return;
+
+		//Per-row procedure
+		auto proc = [&](size_t r) {
+
+			const quint32 j = (quint32)(area.top() + r);
+
+			TRACE_SCOPE_ARG("row", j);
+
+			//Destination row
+			PixelType* row = reinterpret_cast<PixelType*>(target.scanLine(j));
+
+			//Reset row counters of this thread
+			RowCounters& rowCounters = local();
+			rowCounters = RowCounters();
+
+			rowFunc(row, j, (quint32)area.left(), (quint32)area.left() + (quint32)area.width());
+
+			if (counters != nullptr)
+			{
+				counters->addRow(area.width(), rowCounters.samples, rowCounters.skipped);
+			}
 		};
 
 		//Optionally parallelism can be disabled when this macro is defined
 #ifdef NO_PARALLEL_PIXEL_FUNC
 
+		Q_UNUSED(pool);
+		Q_UNUSED(priority);
+
 		//Sequential foreach
-		for (size_t i = 0; i < (target.height() * target.width()); i++)
+		for (size_t r = 0; r < (size_t)area.height(); r++)
 		{
-			proc(i);
+			proc(r);
 		}
 
 #else
 
 		//Parallel foreach
-		//Execute the pixel function for every pixel (concurrently)
-		QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(target.height() * target.width()), proc);
+		//Execute the row function for every row (concurrently)
+		if (pool != nullptr)
+		{
+			pool->parallelFor((size_t)area.height(), priority, proc);
+		}
+		else
+		{
+			QtConcurrent::blockingMap(CountingIterator(0), CountingIterator((size_t)area.height()), proc);
+		}
 
 #endif
 	}
+
+private:
+
+	/*
+		Work done by the current row of a thread
+	*/
+	struct RowCounters
+	{
+		quint64 samples = 0;
+		quint64 skipped = 0;
+	};
+
+	static RowCounters& local()
+	{
+		thread_local RowCounters counters;
+		return counters;
+	}
 };
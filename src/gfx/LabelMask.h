@@ -0,0 +1,100 @@
+/*
+	Label mask class
+
+	One bit per voxel marking the voxels of a segmented region, 1/16th the size of the volume it labels.
+	Bits are stored in 64 bit words in the same order as the voxels of the volume.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <QVector3D>
+#include <QtAlgorithms>
+
+#include "Volume.h"
+
+class LabelMask
+{
+public:
+
+	/*
+		Construct an empty mask
+	*/
+	LabelMask() {}
+
+	/*
+		Construct a mask of a volume size from its words
+	*/
+	LabelMask(Volume::SizeType sizeX, Volume::SizeType sizeY, Volume::SizeType sizeZ, std::vector<quint64> words) :
+		m_words(std::move(words))
+	{
+		m_size[XAxis] = sizeX;
+		m_size[YAxis] = sizeY;
+		m_size[ZAxis] = sizeZ;
+
+		Q_ASSERT(m_words.size() == wordCount((quint64)sizeX * sizeY * sizeZ));
+
+		for (quint64 word : m_words)
+		{
+			m_count += qPopulationCount(word);
+		}
+	}
+
+	/*
+		Number of words needed for a number of voxels
+	*/
+	static size_t wordCount(quint64 voxels) { return (size_t)((voxels + 63) / 64); }
+
+	/*
+		Size of the labelled volume
+	*/
+	Volume::SizeType size(VolumeAxis axis) const { return m_size[axis]; }
+
+	/*
+		Number of voxels in the mask
+	*/
+	quint64 count() const { return m_count; }
+	bool isEmpty() const { return m_count == 0; }
+
+	/*
+		True if a voxel is in the mask, by index into the volume data
+	*/
+	bool contains(Volume::IndexType index) const
+	{
+		return ((m_words[index >> 6] >> (index & 63)) & 1) != 0;
+	}
+
+	/*
+		True if the voxel containing a position in normalized volume coordinates is in the mask
+	*/
+	bool contains(const QVector3D& pos) const
+	{
+		const Volume::IndexType x = voxel(pos.x(), XAxis);
+		const Volume::IndexType y = voxel(pos.y(), YAxis);
+		const Volume::IndexType z = voxel(pos.z(), ZAxis);
+
+		return contains(x + m_size[XAxis] * (y + m_size[YAxis] * z));
+	}
+
+	bool operator==(const LabelMask& other) const
+	{
+		return std::equal(m_size, m_size + 3, other.m_size) && m_words == other.m_words;
+	}
+
+	bool operator!=(const LabelMask& other) const { return !(*this == other); }
+
+private:
+
+	//Voxel of an axis containing a normalized coordinate, clamped to the volume
+	Volume::IndexType voxel(float t, VolumeAxis axis) const
+	{
+		const float v = t * m_size[axis];
+		return (v <= 0.0f) ? 0 : std::min((Volume::IndexType)v, m_size[axis] - 1);
+	}
+
+	Volume::SizeType m_size[3] = { 0, 0, 0 };
+	quint64 m_count = 0;
+
+	std::vector<quint64> m_words;
+};
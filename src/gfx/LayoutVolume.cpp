@@ -0,0 +1,160 @@
+/*
+	Layout volume source
+*/
+
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+#include "LayoutVolume.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Number of bits needed to index an axis
+*/
+static int axisBits(Volume::SizeType size)
+{
+	int bits = 0;
+
+	while (((Volume::SizeType)1 << bits) < size)
+	{
+		bits++;
+	}
+
+	return bits;
+}
+
+LayoutVolume::LayoutVolume(const Volume& volume, VolumeLayout layout) :
+	m_min(volume.min()),
+	m_max(volume.max()),
+	m_layout(layout)
+{
+	TRACE_SCOPE_ARG("buildLayout", layout);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		m_size[axis] = volume.axisSize((VolumeAxis)axis);
+		m_offsets[axis].resize(m_size[axis]);
+	}
+
+	size_t voxels = 0;
+
+	if (layout == LayoutLinear)
+	{
+		const size_t strides[3] = { 1, (size_t)m_size[XAxis], (size_t)m_size[XAxis] * m_size[YAxis] };
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (Volume::IndexType i = 0; i < m_size[axis]; i++)
+			{
+				m_offsets[axis][i] = i * strides[axis];
+			}
+		}
+
+		voxels = strides[2] * m_size[ZAxis];
+	}
+	else if (layout == LayoutBricked)
+	{
+		const size_t brickVoxels = BrickSize * BrickSize * BrickSize;
+
+		//Bricks along each axis, and the strides between bricks and between voxels within a brick
+		size_t bricks[3];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			bricks[axis] = (m_size[axis] + BrickSize - 1) / BrickSize;
+		}
+
+		const size_t brickStrides[3] = { brickVoxels, brickVoxels * bricks[XAxis], brickVoxels * bricks[XAxis] * bricks[YAxis] };
+		const size_t voxelStrides[3] = { 1, BrickSize, BrickSize * BrickSize };
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (Volume::IndexType i = 0; i < m_size[axis]; i++)
+			{
+				m_offsets[axis][i] = (i / BrickSize) * brickStrides[axis] + (i % BrickSize) * voxelStrides[axis];
+			}
+		}
+
+		voxels = brickStrides[2] * bricks[ZAxis];
+	}
+	else
+	{
+		//Assign output bits to the axes in turn, skipping axes which have run out of bits
+		const int bits[3] = { axisBits(m_size[XAxis]), axisBits(m_size[YAxis]), axisBits(m_size[ZAxis]) };
+
+		std::vector<int> positions[3];
+		int next = 0;
+
+		for (int bit = 0; bit < std::max(bits[0], std::max(bits[1], bits[2])); bit++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (bit < bits[axis])
+					positions[axis].push_back(next++);
+			}
+		}
+
+		//Deposit the bits of every coordinate into its positions
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (Volume::IndexType i = 0; i < m_size[axis]; i++)
+			{
+				size_t offset = 0;
+
+				for (int b = 0; b < bits[axis]; b++)
+				{
+					offset |= (size_t)((i >> b) & 1) << positions[axis][b];
+				}
+
+				m_offsets[axis][i] = offset;
+			}
+		}
+
+		voxels = (size_t)1 << next;
+	}
+
+	//Padding takes the lowest value, it is never sampled
+	m_data.assign(voxels, m_min);
+
+	Volume::ElementType* const out = m_data.data();
+
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(m_size[ZAxis]), [&](size_t z) {
+
+		const size_t oz = offsetZ((Volume::IndexType)z);
+
+		for (Volume::IndexType y = 0; y < m_size[YAxis]; y++)
+		{
+			const Volume::ElementType* row = volume.data() + volume.index(0, y, (Volume::IndexType)z);
+			const size_t oyz = oz + offsetY(y);
+
+			for (Volume::IndexType x = 0; x < m_size[XAxis]; x++)
+			{
+				out[oyz + offsetX(x)] = row[x];
+			}
+		}
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QStringList LayoutVolume::layoutNames()
+{
+	return { QStringLiteral("linear"), QStringLiteral("bricked"), QStringLiteral("morton") };
+}
+
+bool LayoutVolume::parseLayout(const QString& name, VolumeLayout& layout)
+{
+	const int index = layoutNames().indexOf(name.trimmed().toLower());
+
+	if (index < 0)
+		return false;
+
+	layout = (VolumeLayout)index;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,115 @@
+/*
+	Layout volume class:
+
+	A copy of a volume with its voxels stored in a different order, for better locality of rays cast in any direction.
+
+	Linear:
+		x fastest, then y, then z, the order of Volume
+
+	Bricked:
+		8x8x8 bricks stored one after another, voxels of a brick in linear order
+
+	Morton:
+		Z-order curve, the bits of x, y and z are interleaved so voxels close in every direction are close in memory.
+		Each axis is padded to a power of two, an axis shorter than the others stops contributing bits once they run out.
+
+	Every layout is separable: the index of a voxel is the sum of an offset of its x, an offset of its y and an offset of its z.
+	Offsets are looked up in per-axis tables, which for Morton order deposit the bits of a coordinate into their interleaved positions.
+	Samplers are written against these offsets (see Volume::offsetX), so they compile for Volume and LayoutVolume alike,
+	and the upper neighbours of a trilinear fetch are the offsets of the next coordinate of each axis.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+#include "Volume.h"
+
+enum VolumeLayout
+{
+	LayoutLinear,
+	LayoutBricked,
+	LayoutMorton
+};
+
+class LayoutVolume
+{
+public:
+
+	//Side of a brick in voxels
+	static const Volume::SizeType BrickSize = 8;
+
+	LayoutVolume() {}
+
+	/*
+		Copy a volume into a given layout
+	*/
+	LayoutVolume(const Volume& volume, VolumeLayout layout);
+
+	/*
+		Dimensions and value range, as of the source volume
+	*/
+	Volume::SizeType sizeX() const { return m_size[XAxis]; }
+	Volume::SizeType sizeY() const { return m_size[YAxis]; }
+	Volume::SizeType sizeZ() const { return m_size[ZAxis]; }
+
+	Volume::ElementType min() const { return m_min; }
+	Volume::ElementType max() const { return m_max; }
+
+	VolumeLayout layout() const { return m_layout; }
+
+	/*
+		Offsets of voxel coordinates into the data buffer, the index of a voxel is the sum of its offsets
+	*/
+	size_t offsetX(Volume::IndexType x) const { return m_offsets[XAxis][x]; }
+	size_t offsetY(Volume::IndexType y) const { return m_offsets[YAxis][y]; }
+	size_t offsetZ(Volume::IndexType z) const { return m_offsets[ZAxis][z]; }
+
+	/*
+		Access voxel from coordinates
+	*/
+	Volume::ElementType at(Volume::IndexType x, Volume::IndexType y, Volume::IndexType z) const
+	{
+		Q_ASSERT(x < sizeX());
+		Q_ASSERT(y < sizeY());
+		Q_ASSERT(z < sizeZ());
+
+		return m_data[offsetX(x) + offsetY(y) + offsetZ(z)];
+	}
+
+	/*
+		Internal data pointer, including padding
+	*/
+	const Volume::ElementType* data() const { return m_data.data(); }
+
+	/*
+		Memory used by the voxels in bytes, including padding
+	*/
+	quint64 bytes() const { return (quint64)m_data.size() * sizeof(Volume::ElementType); }
+
+	/*
+		Names of layouts, indexed by layout
+	*/
+	static QStringList layoutNames();
+
+	/*
+		Parse a layout from its name, returns false if the name is unknown
+	*/
+	static bool parseLayout(const QString& name, VolumeLayout& layout);
+
+private:
+
+	Volume::SizeType m_size[3] = { 0, 0, 0 };
+	Volume::ElementType m_min = 0;
+	Volume::ElementType m_max = 0;
+
+	VolumeLayout m_layout = LayoutLinear;
+
+	//Offset of every coordinate of each axis
+	std::vector<size_t> m_offsets[3];
+
+	std::vector<Volume::ElementType> m_data;
+};
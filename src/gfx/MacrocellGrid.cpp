@@ -0,0 +1,98 @@
+/*
+	Macrocell grid source
+*/
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+#include "MacrocellGrid.h"
+#include "util/CountingIterator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+MacrocellGrid::MacrocellGrid(const Volume* volume)
+{
+	Q_ASSERT(volume != nullptr);
+
+	m_cellsX = (volume->sizeX() + CellSize - 1) / CellSize;
+	m_cellsY = (volume->sizeY() + CellSize - 1) / CellSize;
+	m_cellsZ = (volume->sizeZ() + CellSize - 1) / CellSize;
+
+	m_scaleX = (float)volume->sizeX() / CellSize;
+	m_scaleY = (float)volume->sizeY() / CellSize;
+	m_scaleZ = (float)volume->sizeZ() / CellSize;
+
+	m_max.resize(m_cellsX * m_cellsY * m_cellsZ);
+	Volume::ElementType* dst = m_max.data();
+
+	//Layers of blocks are independent so they can be built concurrently
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(m_cellsZ), [&](size_t cz) {
+
+		//Voxel range of a block, extended by one voxel on each side
+		auto range = [](Volume::SizeType cell, Volume::SizeType size, Volume::IndexType& first, Volume::IndexType& last) {
+			first = cell ? (cell * CellSize - 1) : 0;
+			last = std::min((cell + 1) * CellSize, size - 1);
+		};
+
+		Volume::IndexType z0, z1;
+		range((Volume::SizeType)cz, volume->sizeZ(), z0, z1);
+
+		for (Volume::SizeType cy = 0; cy < m_cellsY; cy++)
+		{
+			Volume::IndexType y0, y1;
+			range(cy, volume->sizeY(), y0, y1);
+
+			for (Volume::SizeType cx = 0; cx < m_cellsX; cx++)
+			{
+				Volume::IndexType x0, x1;
+				range(cx, volume->sizeX(), x0, x1);
+
+				Volume::ElementType value = std::numeric_limits<Volume::ElementType>::min();
+
+				for (Volume::IndexType z = z0; z <= z1; z++)
+				{
+					for (Volume::IndexType y = y0; y <= y1; y++)
+					{
+						const Volume::ElementType* row = volume->data() + volume->index(0, y, z);
+
+						for (Volume::IndexType x = x0; x <= x1; x++)
+						{
+							value = std::max(value, row[x]);
+						}
+					}
+				}
+
+				dst[cx + m_cellsX * (cy + m_cellsY * cz)] = value;
+			}
+		}
+	});
+}
+
+int MacrocellGrid::stepsToExit(const QVector3D& pos, const QVector3D& step, int x, int y, int z) const
+{
+	const int cell[3] = { x, y, z };
+	const float scale[3] = { m_scaleX, m_scaleY, m_scaleZ };
+
+	float steps = std::numeric_limits<float>::max();
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (step[i] == 0.0f)
+			continue;
+
+		//Normalized coordinate of the block face the ray is moving towards
+		const float face = (float)(cell[i] + ((step[i] > 0.0f) ? 1 : 0)) / scale[i];
+
+		steps = std::min(steps, (face - pos[i]) / step[i]);
+	}
+
+	//First step strictly beyond the face, always advancing at least one step
+	steps = std::min(std::floor(steps) + 1.0f, (float)std::numeric_limits<int>::max() / 2);
+
+	return std::max((int)steps, 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+/*
+	Macrocell grid class:
+
+	Divides a volume into cubic blocks of voxels and stores the maximum value of each block.
+
+	Each block also covers the nearest voxel of its neighbours on both sides. Samplers read voxels at
+	voxel coordinates (pos * size - 0.5), so an interpolating sampler at a position inside block c reads
+	voxels 8c-1 to 8c+8, and every one of them is included in the block's maximum.
+	Rays doing a maximum intensity projection can then step over any block whose maximum
+	cannot raise the value found so far, without sampling it.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include <QVector>
+#include <QVector3D>
+
+#include "Volume.h"
+
+class MacrocellGrid
+{
+public:
+
+	//Edge length of a block in voxels
+	static const Volume::SizeType CellSize = 8;
+
+	MacrocellGrid() {}
+
+	/*
+		Build the grid of a volume
+	*/
+	explicit MacrocellGrid(const Volume* volume);
+
+	/*
+		Number of blocks along each axis
+	*/
+	Volume::SizeType cellsX() const { return m_cellsX; }
+	Volume::SizeType cellsY() const { return m_cellsY; }
+	Volume::SizeType cellsZ() const { return m_cellsZ; }
+
+	/*
+		Block containing a normalized volume position, positions outside the volume are clamped to the nearest block
+	*/
+	void cellAt(const QVector3D& pos, int& x, int& y, int& z) const
+	{
+		x = clampCell((int)floorf(pos.x() * m_scaleX), m_cellsX);
+		y = clampCell((int)floorf(pos.y() * m_scaleY), m_cellsY);
+		z = clampCell((int)floorf(pos.z() * m_scaleZ), m_cellsZ);
+	}
+
+	/*
+		Maximum value of a block
+	*/
+	Volume::ElementType max(int x, int y, int z) const
+	{
+		return m_max[x + m_cellsX * (y + m_cellsY * z)];
+	}
+
+	/*
+		Number of ray steps taken from a position before leaving the given block
+	*/
+	int stepsToExit(const QVector3D& pos, const QVector3D& step, int x, int y, int z) const;
+
+private:
+
+	static int clampCell(int cell, Volume::SizeType cells)
+	{
+		return std::max(0, std::min(cell, (int)cells - 1));
+	}
+
+	Volume::SizeType m_cellsX = 0;
+	Volume::SizeType m_cellsY = 0;
+	Volume::SizeType m_cellsZ = 0;
+
+	//Normalized coordinates to block coordinates
+	float m_scaleX = 0.0f;
+	float m_scaleY = 0.0f;
+	float m_scaleZ = 0.0f;
+
+	//Maximum of each block, x major
+	QVector<Volume::ElementType> m_max;
+};
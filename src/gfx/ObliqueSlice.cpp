@@ -0,0 +1,44 @@
+/*
+	Oblique slice source
+*/
+
+#include "ObliqueSlice.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObliqueSlice ObliqueSlice::fromSubimage(const Volume& volume, Volume::IndexType index, VolumeAxis axis)
+{
+	//Normalized position of slice centre along the axis
+	const float w = ((float)index + 0.5f) / volume.axisSize(axis);
+
+	//In-plane axes follow the uv's of the subimage
+	switch (axis)
+	{
+	case XAxis: return ObliqueSlice(QVector3D(w, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f), QVector3D(0.0f, 0.0f, 1.0f));
+	case YAxis: return ObliqueSlice(QVector3D(0.0f, w, 0.0f), QVector3D(1.0f, 0.0f, 0.0f), QVector3D(0.0f, 0.0f, 1.0f));
+	default:    return ObliqueSlice(QVector3D(0.0f, 0.0f, w), QVector3D(1.0f, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f));
+	}
+}
+
+ObliqueSlice ObliqueSlice::centred(const QVector3D& centre, const QQuaternion& orientation, float extent)
+{
+	const QVector3D u = orientation.rotatedVector(QVector3D(extent, 0.0f, 0.0f));
+	const QVector3D v = orientation.rotatedVector(QVector3D(0.0f, extent, 0.0f));
+
+	return ObliqueSlice(centre - (u + v) * 0.5f, u, v);
+}
+
+ObliqueSlice ObliqueSlice::rotated(const QQuaternion& rotation) const
+{
+	const QVector3D u = rotation.rotatedVector(m_uAxis);
+	const QVector3D v = rotation.rotatedVector(m_vAxis);
+
+	return ObliqueSlice(centre() - (u + v) * 0.5f, u, v);
+}
+
+ObliqueSlice ObliqueSlice::translated(float distance) const
+{
+	return ObliqueSlice(m_origin + normal() * distance, m_uAxis, m_vAxis);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
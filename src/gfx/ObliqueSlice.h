@@ -0,0 +1,84 @@
+/*
+	Oblique slice class
+
+	Represents an arbitrary plane through a volume, for multi-planar reformatting.
+
+	The plane is a parallelogram in normalized volume coordinates, given by the corner at uv (0,0)
+	and the two in-plane axes spanning it: position(u, v) = origin + u * uAxis + v * vAxis.
+	Voxel centres lie at (i + 0.5) / size, matching the axis aligned subimages.
+*/
+
+#pragma once
+
+#include <QVector3D>
+#include <QQuaternion>
+
+#include "Volume.h"
+#include "Samplers.h"
+
+class ObliqueSlice
+{
+public:
+
+	/*
+		Construct the slice through the middle of the volume along the z axis
+	*/
+	ObliqueSlice() :
+		ObliqueSlice(QVector3D(0.0f, 0.0f, 0.5f), QVector3D(1.0f, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f))
+	{}
+
+	/*
+		Construct a slice from its corner and in-plane axes
+	*/
+	ObliqueSlice(const QVector3D& origin, const QVector3D& uAxis, const QVector3D& vAxis) :
+		m_origin(origin), m_uAxis(uAxis), m_vAxis(vAxis)
+	{}
+
+	/*
+		Construct the slice covering the same plane as an axis aligned subimage
+	*/
+	static ObliqueSlice fromSubimage(const Volume& volume, Volume::IndexType index, VolumeAxis axis);
+
+	/*
+		Construct a square slice of a given extent centred on a point, with an orientation applied to the z axis slice
+	*/
+	static ObliqueSlice centred(const QVector3D& centre, const QQuaternion& orientation, float extent = 1.0f);
+
+	/*
+		Plane geometry
+	*/
+	const QVector3D& origin() const { return m_origin; }
+	const QVector3D& uAxis() const { return m_uAxis; }
+	const QVector3D& vAxis() const { return m_vAxis; }
+
+	QVector3D centre() const { return m_origin + (m_uAxis + m_vAxis) * 0.5f; }
+	QVector3D normal() const { return QVector3D::crossProduct(m_uAxis, m_vAxis).normalized(); }
+
+	/*
+		Normalized volume coordinates of a point on the plane
+	*/
+	QVector3D position(const UV& coords) const { return m_origin + m_uAxis * coords.u + m_vAxis * coords.v; }
+
+	/*
+		Rotate the plane about its centre
+	*/
+	ObliqueSlice rotated(const QQuaternion& rotation) const;
+
+	/*
+		Move the plane along its normal
+	*/
+	ObliqueSlice translated(float distance) const;
+
+	bool operator==(const ObliqueSlice& other) const
+	{
+		return m_origin == other.m_origin && m_uAxis == other.m_uAxis && m_vAxis == other.m_vAxis;
+	}
+
+	bool operator!=(const ObliqueSlice& other) const { return !(*this == other); }
+
+private:
+
+	QVector3D m_origin;
+	QVector3D m_uAxis;
+	QVector3D m_vAxis;
+};
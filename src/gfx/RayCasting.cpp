@@ -5,50 +5,84 @@
 */
 
 #include <algorithm>
+#include <limits>
 
 #include "RayCasting.h"
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/*
-	min/max vector helpers
-*/
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-QVector3D min(const QVector3D& a, const QVector3D& b)
+RaycastResult Raycast::intersects(const AABB& box, const Ray& ray, size_t sampleFrequency)
 {
-	return QVector3D(std::min(a.x(), b.x()), std::min(a.y(), b.y()), std::min(a.z(), b.z()));
+	return intersects(box, QVector<Plane>(), ray, sampleFrequency);
 }
 
-QVector3D max(const QVector3D& a, const QVector3D& b)
+RaycastResult Raycast::intersects(const AABB& box, const QVector<Plane>& planes, const Ray& ray, size_t sampleFrequency)
 {
-	return QVector3D(std::max(a.x(), b.x()), std::max(a.y(), b.y()), std::max(a.z(), b.z()));
-}
+	//Only points in front of the ray origin are sampled
+	float t0 = 0.0f;
+	float t1 = std::numeric_limits<float>::max();
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//If intersects
+	if (clip(box, planes, ray, t0, t1))
+	{
+		return RaycastResult(ray, t0, t1, 1.0f / sampleFrequency);
+	}
 
-RaycastResult Raycast::intersects(const AABB& box, const Ray& ray, size_t sampleFrequency)
+	return RaycastResult::nohit();
+}
+
+bool Raycast::clip(const AABB& box, const QVector<Plane>& planes, const Ray& ray, float& t0, float& t1)
 {
-	using namespace std;
+	const float epsilon = 1e-8f;
+	const QVector3D origin = ray.origin.toVector3D();
 
-	//intersection vectors with planes
-	QVector3D tmin = (box.min - ray.origin.toVector3D()) / ray.dir;
-	QVector3D tmax = (box.max - ray.origin.toVector3D()) / ray.dir;
+	//Slabs of the box
+	for (int i = 0; i < 3; i++)
+	{
+		//Parallel to the slab, either always inside or never
+		if (std::abs(ray.dir[i]) < epsilon)
+		{
+			if (origin[i] < box.min[i] || origin[i] > box.max[i])
+				return false;
 
-	QVector3D tnear = min(tmin, tmax);
-	QVector3D tfar = max(tmin, tmax);
+			continue;
+		}
 
-	//entry point
-	float t0 = max(max(tnear.x(), 0.0f), max(tnear.y(), tnear.z()));
-	//exit point
-	float t1 = min(tfar.x(), min(tfar.y(), tfar.z()));
+		//intersection distances with the two planes of the slab
+		float tnear = (box.min[i] - origin[i]) / ray.dir[i];
+		float tfar = (box.max[i] - origin[i]) / ray.dir[i];
 
-	//If intersects
-	if ((t1 > 0.0f) && (t0 < t1))
+		if (tnear > tfar)
+			std::swap(tnear, tfar);
+
+		t0 = std::max(t0, tnear);
+		t1 = std::min(t1, tfar);
+	}
+
+	//Half spaces of the planes
+	for (const Plane& plane : planes)
 	{
-		return RaycastResult(ray, t0, t1, 1.0f / sampleFrequency);
+		const float start = plane.signedDistance(origin);
+		const float rate = QVector3D::dotProduct(plane.normal, ray.dir);
+
+		if (std::abs(rate) < epsilon)
+		{
+			if (start < 0.0f)
+				return false;
+
+			continue;
+		}
+
+		//Distance where the ray crosses the plane
+		const float t = -start / rate;
+
+		if (rate > 0.0f)
+			t0 = std::max(t0, t); //entering the positive side
+		else
+			t1 = std::min(t1, t); //leaving the positive side
 	}
 
-	return RaycastResult::nohit();
+	return t0 < t1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
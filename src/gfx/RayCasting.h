@@ -6,6 +6,10 @@
 
 #pragma once
 
+#include <cmath>
+#include <algorithm>
+
+#include <QVector>
 #include <QVector3D>
 #include <QVector4D>
 
@@ -27,6 +31,35 @@ struct AABB
 };
 
 
+/*
+	Plane
+
+	Points on the positive side satisfy dot(normal, point) + distance >= 0
+*/
+struct Plane
+{
+	QVector3D normal;
+	float distance = 0.0f;
+
+	Plane() {}
+
+	Plane(const QVector3D& _normal, float _distance) :
+		normal(_normal), distance(_distance)
+	{}
+
+	/*
+		Construct the plane through a point, facing the given normal
+	*/
+	static Plane fromPoint(const QVector3D& point, const QVector3D& normal)
+	{
+		return Plane(normal, -QVector3D::dotProduct(normal, point));
+	}
+
+	float signedDistance(const QVector3D& point) const { return QVector3D::dotProduct(normal, point) + distance; }
+
+	bool operator==(const Plane& other) const { return normal == other.normal && distance == other.distance; }
+};
+
 /*
 	3D Ray
 */
@@ -124,6 +157,23 @@ public:
 	iterator begin() const { return RayIterator(m_start, m_ray.dir, m_step); }
 	iterator end()   const { return RayIterator(m_end,   m_ray.dir, m_step); }
 
+	/*
+		First sample point, and offset between consecutive sample points
+	*/
+	QVector3D start() const { return m_start; }
+	QVector3D stepVector() const { return m_ray.dir * m_step; }
+
+	/*
+		Number of sample points, matching the points visited by iterating from begin to end
+	*/
+	int samples() const
+	{
+		if (m_step <= 0.0f)
+			return 0;
+
+		return std::max((int)std::ceil((m_start.distanceToPoint(m_end) / m_step) - 1.0f), 0);
+	}
+
 	/*
 		True if the ray cast has intersected something
 	*/
@@ -165,6 +215,18 @@ public:
 		A sampling frequency can be specified
 	*/
 	static RaycastResult intersects(const AABB& box, const Ray& ray, size_t sampleFrequency = 100);
+
+	/*
+		Perform an intersection test on the part of a given Bounding Box on the positive side of a set of planes
+	*/
+	static RaycastResult intersects(const AABB& box, const QVector<Plane>& planes, const Ray& ray, size_t sampleFrequency = 100);
+
+	/*
+		Narrow an interval of ray distances [t0, t1] to the part inside a box and on the positive side of a set of planes.
+
+		Returns false if nothing of the interval is left.
+	*/
+	static bool clip(const AABB& box, const QVector<Plane>& planes, const Ray& ray, float& t0, float& t1);
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
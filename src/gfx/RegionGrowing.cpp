@@ -0,0 +1,195 @@
+/*
+	Region growing source
+*/
+
+#include <atomic>
+#include <memory>
+
+#include <QtConcurrentMap>
+
+#include "RegionGrowing.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+enum Constants
+{
+	//Frontier voxels tested by one task
+	BATCH_SIZE = 4096
+};
+
+/*
+	Offset of a neighbour
+*/
+struct NeighbourOffset
+{
+	int x, y, z;
+};
+
+/*
+	Offsets of the neighbours of a connectivity
+*/
+static QVector<NeighbourOffset> neighbourOffsets(Connectivity connectivity)
+{
+	QVector<NeighbourOffset> offsets;
+
+	for (int z = -1; z <= 1; z++)
+	{
+		for (int y = -1; y <= 1; y++)
+		{
+			for (int x = -1; x <= 1; x++)
+			{
+				//Number of axes the neighbour is offset along: 1 face, 2 edge, 3 corner
+				const int axes = (x != 0) + (y != 0) + (z != 0);
+
+				if (axes == 0 || axes > (int)connectivity + 1)
+					continue;
+
+				offsets.append({ x, y, z });
+			}
+		}
+	}
+
+	return offsets;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LabelMask RegionGrowing::grow(
+	const Volume& volume,
+	Volume::IndexType x, Volume::IndexType y, Volume::IndexType z,
+	const Options& options,
+	RenderCounters* counters,
+	RenderThreadPool* pool,
+	RenderPriority priority
+)
+{
+	TRACE_SCOPE("growRegion");
+
+	const Volume::SizeType sizeX = volume.sizeX();
+	const Volume::SizeType sizeY = volume.sizeY();
+	const Volume::SizeType sizeZ = volume.sizeZ();
+
+	const size_t words = LabelMask::wordCount((quint64)sizeX * sizeY * sizeZ);
+
+	if (x >= sizeX || y >= sizeY || z >= sizeZ)
+		return LabelMask(sizeX, sizeY, sizeZ, std::vector<quint64>(words, 0));
+
+	const Volume::ElementType lower = options.lower;
+	const Volume::ElementType upper = options.upper;
+
+	auto inRange = [&](Volume::IndexType index) {
+		const Volume::ElementType value = volume.data()[index];
+		return value >= lower && value <= upper;
+	};
+
+	const Volume::IndexType seed = volume.index(x, y, z);
+
+	if (!inRange(seed))
+		return LabelMask(sizeX, sizeY, sizeZ, std::vector<quint64>(words, 0));
+
+	//Mask bits are claimed by whichever batch reaches a voxel first
+	std::unique_ptr<std::atomic<quint64>[]> mask(new std::atomic<quint64>[words]);
+
+	for (size_t i = 0; i < words; i++)
+	{
+		mask[i].store(0, std::memory_order_relaxed);
+	}
+
+	auto claim = [&](Volume::IndexType index) {
+		const quint64 bit = 1ull << (index & 63);
+		std::atomic<quint64>& word = mask[index >> 6];
+
+		//Cheap test first, most neighbours of a frontier voxel are already claimed
+		if (word.load(std::memory_order_relaxed) & bit)
+			return false;
+
+		return (word.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+	};
+
+	claim(seed);
+
+	const QVector<NeighbourOffset> offsets = neighbourOffsets(options.connectivity);
+
+	QVector<Volume::IndexType> frontier = { seed };
+	QVector<QVector<Volume::IndexType>> added;
+
+	while (!frontier.isEmpty())
+	{
+		TRACE_SCOPE_ARG("growStep", frontier.size());
+
+		const size_t batches = ((size_t)frontier.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+		added.resize((int)batches);
+
+		auto proc = [&](size_t batch) {
+
+			QVector<Volume::IndexType>& next = added[(int)batch];
+			next.clear();
+
+			const int begin = (int)(batch * BATCH_SIZE);
+			const int end = std::min(begin + (int)BATCH_SIZE, frontier.size());
+
+			quint64 tested = 0;
+
+			for (int f = begin; f < end; f++)
+			{
+				const Volume::IndexType index = frontier[f];
+
+				const Volume::IndexType vx = index % sizeX;
+				const Volume::IndexType vy = (index / sizeX) % sizeY;
+				const Volume::IndexType vz = index / (sizeX * sizeY);
+
+				for (const NeighbourOffset& offset : offsets)
+				{
+					//Coordinates wrap around below zero, so one unsigned comparison tests both bounds
+					const Volume::IndexType nx = vx + offset.x;
+					const Volume::IndexType ny = vy + offset.y;
+					const Volume::IndexType nz = vz + offset.z;
+
+					if (nx >= sizeX || ny >= sizeY || nz >= sizeZ)
+						continue;
+
+					const Volume::IndexType neighbour = volume.index(nx, ny, nz);
+					tested++;
+
+					if (inRange(neighbour) && claim(neighbour))
+					{
+						next.append(neighbour);
+					}
+				}
+			}
+
+			if (counters != nullptr)
+			{
+				counters->addRow(next.size(), tested, 0);
+			}
+		};
+
+		if (pool != nullptr)
+		{
+			pool->parallelFor(batches, priority, proc);
+		}
+		else
+		{
+			QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(batches), proc);
+		}
+
+		//Voxels added by every batch form the next frontier
+		frontier.clear();
+
+		for (const QVector<Volume::IndexType>& next : added)
+		{
+			frontier += next;
+		}
+	}
+
+	std::vector<quint64> result(words);
+
+	for (size_t i = 0; i < words; i++)
+	{
+		result[i] = mask[i].load(std::memory_order_relaxed);
+	}
+
+	return LabelMask(sizeX, sizeY, sizeZ, std::move(result));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
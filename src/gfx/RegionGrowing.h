@@ -0,0 +1,56 @@
+/*
+	Region growing segmentation
+
+	Labels every voxel connected to a seed voxel through voxels inside an intensity range,
+	for example bone above a threshold or the air of the airways.
+
+	The region grows in parallel one frontier at a time: the voxels added by the last step are split into batches,
+	each batch tests the neighbours of its voxels and claims those in range by atomically setting their mask bit,
+	so a voxel joins the region exactly once whichever batch reaches it first.
+*/
+
+#pragma once
+
+#include "Volume.h"
+#include "LabelMask.h"
+#include "RenderStatistics.h"
+#include "RenderThreadPool.h"
+
+/*
+	Neighbours of a voxel the region grows into
+*/
+enum Connectivity
+{
+	ConnectFaces,   //6 neighbours sharing a face
+	ConnectEdges,   //18 neighbours sharing a face or an edge
+	ConnectCorners  //26 neighbours sharing a face, an edge or a corner
+};
+
+class RegionGrowing
+{
+public:
+
+	struct Options
+	{
+		//Inclusive intensity range of the region
+		Volume::ElementType lower = 0;
+		Volume::ElementType upper = 0;
+
+		Connectivity connectivity = ConnectFaces;
+	};
+
+	/*
+		Grow a region from a seed voxel, the mask is empty if the seed is outside the intensity range.
+
+		Optionally voxels added and neighbours tested are counted as pixels and samples.
+		Batches run on the given thread pool at the given priority, or on QtConcurrent's global pool if no pool is given.
+	*/
+	static LabelMask grow(
+		const Volume& volume,
+		Volume::IndexType x, Volume::IndexType y, Volume::IndexType z,
+		const Options& options,
+		RenderCounters* counters = nullptr,
+		RenderThreadPool* pool = nullptr,
+		RenderPriority priority = PriorityInteractive
+	);
+};
@@ -0,0 +1,130 @@
+/*
+	Render statistics source
+*/
+
+#include "RenderStatistics.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QString RenderStats::toString() const
+{
+	//Abbreviate large counts
+	auto count = [](quint64 n)->QString {
+		if (n >= 1000000)
+			return QString::number(n / 1.0e6, 'f', 1) + "M";
+		if (n >= 1000)
+			return QString::number(n / 1.0e3, 'f', 1) + "k";
+		return QString::number(n);
+	};
+
+	return QString("%1 ms\n%2 px, %3 samples\n%4 skipped, %5 hits, %6 threads")
+		.arg(wallTimeMs(), 0, 'f', 2)
+		.arg(count(pixels))
+		.arg(count(samples))
+		.arg(count(raysSkipped))
+		.arg(cacheHits)
+		.arg(threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static QAtomicInteger<quint64> s_nextCounterId(1);
+
+RenderCounters::RenderCounters() :
+	m_id(s_nextCounterId.fetchAndAddRelaxed(1)),
+	m_pixels(0),
+	m_samples(0),
+	m_skipped(0),
+	m_cacheHits(0),
+	m_threads(0)
+{}
+
+void RenderCounters::addRow(quint64 pixels, quint64 samples, quint64 skipped)
+{
+	//Id of the last draw call this thread took part in
+	thread_local quint64 lastId = 0;
+
+	if (lastId != m_id)
+	{
+		lastId = m_id;
+		m_threads.fetchAndAddRelaxed(1);
+	}
+
+	m_pixels.fetchAndAddRelaxed(pixels);
+	m_samples.fetchAndAddRelaxed(samples);
+	m_skipped.fetchAndAddRelaxed(skipped);
+}
+
+RenderStats RenderCounters::stats(qint64 wallTimeNs) const
+{
+	RenderStats stats;
+	stats.wallTimeNs = wallTimeNs;
+	stats.pixels = m_pixels.load();
+	stats.samples = m_samples.load();
+	stats.raysSkipped = m_skipped.load();
+	stats.cacheHits = m_cacheHits.load();
+	stats.threads = m_threads.load();
+	return stats;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RenderStatistics::add(const RenderStats& stats)
+{
+	if (m_window.size() < Window)
+	{
+		m_window.append(stats);
+	}
+	else
+	{
+		m_window[m_next] = stats;
+	}
+
+	m_next = (m_next + 1) % Window;
+	m_count++;
+}
+
+RenderStats RenderStatistics::last() const
+{
+	if (m_window.isEmpty())
+		return RenderStats();
+
+	return m_window[(m_next + Window - 1) % Window];
+}
+
+RenderStats RenderStatistics::average() const
+{
+	RenderStats mean;
+
+	if (m_window.isEmpty())
+		return mean;
+
+	for (const RenderStats& stats : m_window)
+	{
+		mean.wallTimeNs += stats.wallTimeNs;
+		mean.pixels += stats.pixels;
+		mean.samples += stats.samples;
+		mean.raysSkipped += stats.raysSkipped;
+		mean.cacheHits += stats.cacheHits;
+		mean.threads += stats.threads;
+	}
+
+	const int n = m_window.size();
+	mean.wallTimeNs /= n;
+	mean.pixels /= n;
+	mean.samples /= n;
+	mean.raysSkipped /= n;
+	mean.cacheHits /= n;
+	mean.threads /= n;
+
+	return mean;
+}
+
+void RenderStatistics::reset()
+{
+	m_window.clear();
+	m_next = 0;
+	m_count = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,136 @@
+/*
+	Render statistics
+
+	RenderStats:
+		Figures describing a single draw call
+
+	RenderCounters:
+		Counters updated concurrently by the threads taking part in a draw call
+
+	RenderStatistics:
+		Rolling averages over recent draw calls
+*/
+
+#pragma once
+
+#include <QAtomicInteger>
+#include <QVector>
+#include <QString>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Statistics of one draw call
+*/
+struct RenderStats
+{
+	//Elapsed time of draw call
+	qint64 wallTimeNs = 0;
+	//Number of pixels drawn
+	quint64 pixels = 0;
+	//Number of volume samples taken
+	quint64 samples = 0;
+	//Number of rays which did not need sampling
+	quint64 raysSkipped = 0;
+	//Number of times cached data was reused
+	quint64 cacheHits = 0;
+	//Number of distinct threads which drew pixels
+	quint32 threads = 0;
+
+	double wallTimeMs() const { return wallTimeNs / 1.0e6; }
+
+	/*
+		Format as a short multi-line summary
+	*/
+	QString toString() const;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Draw call counters
+
+	Rows are accumulated locally by each thread then added atomically.
+*/
+class RenderCounters
+{
+public:
+
+	RenderCounters();
+
+	/*
+		Add the work done for one row by the calling thread
+	*/
+	void addRow(quint64 pixels, quint64 samples, quint64 skipped);
+
+	/*
+		Add a reuse of cached data
+	*/
+	void addCacheHit() { m_cacheHits.fetchAndAddRelaxed(1); }
+
+	/*
+		Collect the counters into a statistics structure
+	*/
+	RenderStats stats(qint64 wallTimeNs) const;
+
+private:
+
+	Q_DISABLE_COPY(RenderCounters)
+
+	//Unique id used by threads to detect their first row of this draw call
+	quint64 m_id;
+
+	QAtomicInteger<quint64> m_pixels;
+	QAtomicInteger<quint64> m_samples;
+	QAtomicInteger<quint64> m_skipped;
+	QAtomicInteger<quint64> m_cacheHits;
+	QAtomicInteger<quint32> m_threads;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Rolling statistics over the most recent draw calls
+*/
+class RenderStatistics
+{
+public:
+
+	//Number of draw calls averaged
+	static const int Window = 32;
+
+	RenderStatistics() {}
+
+	/*
+		Record a draw call
+	*/
+	void add(const RenderStats& stats);
+
+	/*
+		Most recent draw call
+	*/
+	RenderStats last() const;
+
+	/*
+		Mean of the draw calls in the window
+	*/
+	RenderStats average() const;
+
+	/*
+		Total number of draw calls recorded
+	*/
+	quint64 count() const { return m_count; }
+
+	/*
+		Forget all recorded draw calls
+	*/
+	void reset();
+
+private:
+
+	QVector<RenderStats> m_window;
+	int m_next = 0;
+	quint64 m_count = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
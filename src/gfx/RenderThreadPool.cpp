@@ -0,0 +1,263 @@
+/*
+	Render thread pool source
+*/
+
+#include <algorithm>
+
+#include <QThread>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#include "RenderThreadPool.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//Number of items the current thread is running, greater than one when work is submitted from inside an item
+static thread_local int t_itemDepth = 0;
+
+/*
+	Worker thread
+*/
+class RenderThreadPool::Worker : public QThread
+{
+public:
+
+	Worker(RenderThreadPool* pool, int index, int cpu) :
+		m_pool(pool), m_index(index), m_cpu(cpu)
+	{}
+
+protected:
+
+	void run() override
+	{
+		if (m_cpu >= 0)
+		{
+			pin(m_cpu);
+		}
+
+		m_pool->work(m_index);
+	}
+
+private:
+
+	//Restrict the current thread to a CPU
+	static void pin(int cpu)
+	{
+#if defined(Q_OS_LINUX)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(Q_OS_WIN)
+		SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+#else
+		Q_UNUSED(cpu);
+#endif
+	}
+
+	RenderThreadPool* m_pool;
+	int m_index;
+	int m_cpu;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderThreadPool::RenderThreadPool(int workers)
+{
+	startWorkers(workers);
+}
+
+RenderThreadPool::~RenderThreadPool()
+{
+	stopWorkers();
+}
+
+int RenderThreadPool::defaultWorkerCount()
+{
+	return std::max(QThread::idealThreadCount() - 1, 0);
+}
+
+int RenderThreadPool::workerCount() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_workers.size();
+}
+
+void RenderThreadPool::setWorkerCount(int workers)
+{
+	stopWorkers();
+	startWorkers(workers);
+}
+
+QList<int> RenderThreadPool::affinity() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_affinity;
+}
+
+void RenderThreadPool::setAffinity(const QList<int>& cpus)
+{
+	const int workers = workerCount();
+
+	stopWorkers();
+
+	{
+		QMutexLocker lock(&m_mutex);
+		m_affinity = cpus;
+	}
+
+	startWorkers(workers);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RenderThreadPool::startWorkers(int count)
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_stopping = false;
+
+	for (int i = 0; i < std::max(count, 0); i++)
+	{
+		const int cpu = m_affinity.isEmpty() ? -1 : m_affinity[i % m_affinity.size()];
+
+		Worker* worker = new Worker(this, i, cpu);
+		m_workers.append(worker);
+		worker->start();
+	}
+}
+
+void RenderThreadPool::stopWorkers()
+{
+	QVector<Worker*> workers;
+
+	{
+		QMutexLocker lock(&m_mutex);
+		m_stopping = true;
+		m_workAvailable.wakeAll();
+		workers.swap(m_workers);
+	}
+
+	for (Worker* worker : workers)
+	{
+		worker->wait();
+		delete worker;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RenderThreadPool::parallelFor(size_t count, RenderPriority priority, const std::function<void(size_t)>& body)
+{
+	if (count == 0)
+		return;
+
+	Job job;
+	job.body = &body;
+	job.count = count;
+	job.priority = priority;
+
+	QMutexLocker lock(&m_mutex);
+
+	//Insert ahead of jobs of the same or lower priority
+	auto pos = std::find_if(m_jobs.begin(), m_jobs.end(), [&](const Job* other) { return other->priority >= priority; });
+	m_jobs.insert(pos, &job);
+
+	m_workAvailable.wakeAll();
+
+	while (job.finished < job.count)
+	{
+		//Take part in the job, unless higher priority work is waiting for threads.
+		//A thread already running an item never yields, the item it holds may be what the other work is waiting on.
+		if (job.next < job.count && (t_itemDepth > 0 || !preempted(&job)))
+		{
+			runItem(&job);
+		}
+		else
+		{
+			m_progress.wait(&m_mutex);
+		}
+	}
+
+	m_jobs.removeOne(&job);
+}
+
+void RenderThreadPool::work(int index)
+{
+	Q_UNUSED(index);
+
+	QMutexLocker lock(&m_mutex);
+
+	while (!m_stopping)
+	{
+		//Pick again after every item so higher priority work is started as soon as possible
+		Job* job = select();
+
+		if (job == nullptr)
+		{
+			m_workAvailable.wait(&m_mutex);
+			continue;
+		}
+
+		runItem(job);
+	}
+}
+
+void RenderThreadPool::runItem(Job* job)
+{
+	const size_t item = job->next++;
+
+	//Lower priority submitters may be waiting for this job to have no more unclaimed items
+	if (job->next == job->count)
+	{
+		m_progress.wakeAll();
+	}
+
+	m_mutex.unlock();
+
+	t_itemDepth++;
+	(*job->body)(item);
+	t_itemDepth--;
+
+	m_mutex.lock();
+
+	//The submitter may release the job as soon as it is finished, it must not be used after this
+	if (++job->finished == job->count)
+	{
+		m_progress.wakeAll();
+	}
+}
+
+RenderThreadPool::Job* RenderThreadPool::select() const
+{
+	for (Job* job : m_jobs)
+	{
+		if (job->next < job->count)
+			return job;
+	}
+
+	return nullptr;
+}
+
+bool RenderThreadPool::preempted(const Job* job) const
+{
+	for (const Job* other : m_jobs)
+	{
+		if (other->priority >= job->priority)
+			break;
+
+		if (other->next < other->count)
+			return true;
+	}
+
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
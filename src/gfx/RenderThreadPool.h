@@ -0,0 +1,113 @@
+/*
+	Render thread pool
+
+	Runs the rows/tiles of draw calls on a dedicated set of worker threads, separate from QtConcurrent's global pool.
+
+	Work is submitted with a priority class. Workers pick the next item of the highest priority
+	work available each time they finish an item, so lower priority draws are preempted between
+	tiles whenever higher priority work arrives. The thread submitting work takes part in it,
+	unless it is lower priority than other work waiting for threads, in which case it yields.
+	Threads submitting work from inside an item always take part, so nested work cannot deadlock.
+
+	Within a priority class the most recently submitted work is preferred, so work submitted from
+	inside a worker (eg. the rows of a frame in a batch of frames) is completed before more is started.
+*/
+
+#pragma once
+
+#include <functional>
+
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+
+/*
+	Priority classes, highest first
+*/
+enum RenderPriority
+{
+	PriorityInteractive, //Subimage the user is interacting with
+	PriorityView,        //3D view
+	PriorityBackground   //Thumbnails, prefetching
+};
+
+class RenderThreadPool
+{
+	Q_DISABLE_COPY(RenderThreadPool)
+
+public:
+
+	/*
+		Construct a pool with a number of worker threads, defaults to one less than the number of cores
+		as the submitting thread also does work
+	*/
+	explicit RenderThreadPool(int workers = defaultWorkerCount());
+
+	~RenderThreadPool();
+
+	/*
+		Number of worker threads, not including submitting threads.
+
+		Must only be changed while the pool is idle.
+	*/
+	int workerCount() const;
+	void setWorkerCount(int workers);
+
+	/*
+		Pin workers to CPUs, worker i runs on cpus[i % cpus.size()]. An empty list removes pinning.
+
+		Supported on Linux and Windows, ignored elsewhere. Must only be changed while the pool is idle.
+	*/
+	QList<int> affinity() const;
+	void setAffinity(const QList<int>& cpus);
+
+	/*
+		Call a function for every index in [0, count) and wait for all calls to complete
+	*/
+	void parallelFor(size_t count, RenderPriority priority, const std::function<void(size_t)>& body);
+
+	static int defaultWorkerCount();
+
+private:
+
+	/*
+		Work submitted by a call to parallelFor
+	*/
+	struct Job
+	{
+		const std::function<void(size_t)>* body;
+		size_t count;
+		RenderPriority priority;
+
+		size_t next = 0;     //next unclaimed index
+		size_t finished = 0; //number of completed indices
+	};
+
+	class Worker;
+
+	//Worker thread procedure
+	void work(int index);
+
+	//Highest priority job with unclaimed items, requires lock
+	Job* select() const;
+	//True if a job of higher priority than the given one has unclaimed items, requires lock
+	bool preempted(const Job* job) const;
+
+	//Claim and run one item of a job, requires lock which is released while running
+	void runItem(Job* job);
+
+	void startWorkers(int count);
+	void stopWorkers();
+
+	mutable QMutex m_mutex;
+	QWaitCondition m_workAvailable;
+	QWaitCondition m_progress;
+
+	//Jobs with unfinished items, ordered by priority then newest first
+	QList<Job*> m_jobs;
+
+	QVector<Worker*> m_workers;
+	QList<int> m_affinity;
+	bool m_stopping = false;
+};
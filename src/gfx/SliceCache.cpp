@@ -0,0 +1,79 @@
+/*
+	Slice cache source
+*/
+
+#include <cstring>
+
+#include "SliceCache.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SliceCache::SliceCache(qint64 capacity) :
+	m_slices((int)std::max<qint64>(capacity / 1024, 1))
+{
+}
+
+bool SliceCache::fetch(Volume::IndexType index, ImageBuffer& target) const
+{
+	Q_ASSERT(target.format() == ImageBuffer::Gray8);
+
+	QMutexLocker lock(&m_mutex);
+
+	//Lookup marks the slice as recently used
+	const QByteArray* slice = const_cast<QCache<quint64, QByteArray>&>(m_slices).object(key(index, target.width(), target.height()));
+
+	if (slice == nullptr)
+		return false;
+
+	for (quint32 j = 0; j < target.height(); j++)
+	{
+		memcpy(target.scanLine(j), slice->constData() + ((size_t)j * target.width()), target.width());
+	}
+
+	return true;
+}
+
+bool SliceCache::contains(Volume::IndexType index, quint32 width, quint32 height) const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_slices.contains(key(index, width, height));
+}
+
+void SliceCache::insert(Volume::IndexType index, const ImageBuffer& image, quint32 generation)
+{
+	Q_ASSERT(image.format() == ImageBuffer::Gray8);
+
+	//Strip row padding
+	QByteArray* slice = new QByteArray((int)(image.width() * image.height()), Qt::Uninitialized);
+
+	for (quint32 j = 0; j < image.height(); j++)
+	{
+		memcpy(slice->data() + ((size_t)j * image.width()), image.scanLine(j), image.width());
+	}
+
+	QMutexLocker lock(&m_mutex);
+
+	if (generation != m_generation)
+	{
+		delete slice;
+		return;
+	}
+
+	m_slices.insert(key(index, image.width(), image.height()), slice, std::max(slice->size() / 1024, 1));
+}
+
+quint32 SliceCache::generation() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_generation;
+}
+
+void SliceCache::clear()
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_slices.clear();
+	m_generation++;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
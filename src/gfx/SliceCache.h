@@ -0,0 +1,70 @@
+/*
+	Slice cache
+
+	Stores rendered subimages of an axis, keyed by index and image size, so slices drawn ahead of
+	time can be presented without drawing them again. Least recently used slices are discarded once
+	the cache is full.
+
+	Safe to use from multiple threads. Slices drawn before the cache was last cleared are discarded.
+*/
+
+#pragma once
+
+#include <QCache>
+#include <QByteArray>
+#include <QMutex>
+
+#include "Volume.h"
+#include "ImageBuffer.h"
+
+class SliceCache
+{
+	Q_DISABLE_COPY(SliceCache)
+
+public:
+
+	/*
+		Construct a cache holding up to the given number of bytes of slices
+	*/
+	explicit SliceCache(qint64 capacity = 64 * 1024 * 1024);
+
+	/*
+		Copy a cached slice into a target buffer of the same size, returns false if the slice is not cached
+	*/
+	bool fetch(Volume::IndexType index, ImageBuffer& target) const;
+
+	/*
+		True if a slice of the given size is cached
+	*/
+	bool contains(Volume::IndexType index, quint32 width, quint32 height) const;
+
+	/*
+		Store a grey scale slice, ignored if the cache was cleared since the given generation
+	*/
+	void insert(Volume::IndexType index, const ImageBuffer& image, quint32 generation);
+
+	/*
+		Number of times the cache has been cleared.
+
+		Used to detect slices which became stale while being drawn.
+	*/
+	quint32 generation() const;
+
+	/*
+		Discard every slice
+	*/
+	void clear();
+
+private:
+
+	static quint64 key(Volume::IndexType index, quint32 width, quint32 height)
+	{
+		return ((quint64)index << 32) | ((quint64)(width & 0xffff) << 16) | (height & 0xffff);
+	}
+
+	mutable QMutex m_mutex;
+
+	//Rows without padding, cost in kilobytes
+	QCache<quint64, QByteArray> m_slices;
+	quint32 m_generation = 0;
+};
@@ -0,0 +1,100 @@
+/*
+	Slice prefetcher source
+*/
+
+#include <QtConcurrentRun>
+
+#include "SlicePrefetcher.h"
+#include "util/Trace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SlicePrefetcher::SlicePrefetcher(VolumeRender* render, VolumeAxis axis, SliceCache* cache) :
+	m_render(render),
+	m_axis(axis),
+	m_cache(cache),
+	m_request(0)
+{
+	Q_ASSERT(render != nullptr);
+	Q_ASSERT(cache != nullptr);
+}
+
+SlicePrefetcher::~SlicePrefetcher()
+{
+	cancel();
+
+	for (QFuture<void>& future : m_running)
+	{
+		future.waitForFinished();
+	}
+}
+
+void SlicePrefetcher::prefetch(Volume::IndexType index, int direction, quint32 width, quint32 height)
+{
+	const quint32 request = ++m_request;
+
+	//Forget finished requests
+	for (auto it = m_running.begin(); it != m_running.end();)
+	{
+		it = it->isFinished() ? m_running.erase(it) : it + 1;
+	}
+
+	if (m_count == 0 || width == 0 || height == 0)
+		return;
+
+	const int size = (int)m_render->volume()->axisSize(m_axis);
+	const int ahead = (direction < 0) ? -1 : 1;
+
+	//Slices ahead then behind, nearest first
+	const int counts[2] = { m_count, std::max(m_count / 4, 1) };
+	const int steps[2] = { ahead, -ahead };
+
+	QList<Volume::IndexType> indices;
+
+	for (int side = 0; side < 2; side++)
+	{
+		for (int i = 1; i <= counts[side]; i++)
+		{
+			const int slice = (int)index + steps[side] * i;
+
+			if (slice < 0 || slice >= size)
+				break;
+
+			if (!m_cache->contains((Volume::IndexType)slice, width, height))
+				indices.append((Volume::IndexType)slice);
+		}
+	}
+
+	if (indices.isEmpty())
+		return;
+
+	const quint32 generation = m_cache->generation();
+
+	m_running.append(QtConcurrent::run([=]() {
+		run(indices, width, height, request, generation);
+	}));
+}
+
+void SlicePrefetcher::cancel()
+{
+	++m_request;
+}
+
+void SlicePrefetcher::run(const QList<Volume::IndexType>& indices, quint32 width, quint32 height, quint32 request, quint32 generation)
+{
+	ImageBuffer target(width, height, ImageBuffer::Gray8);
+
+	for (Volume::IndexType index : indices)
+	{
+		//Superseded by a newer request
+		if (m_request.load() != request)
+			return;
+
+		TRACE_SCOPE_ARG("prefetchSlice", index);
+
+		m_render->drawSubimage(target, index, m_axis, PriorityBackground);
+		m_cache->insert(index, target, generation);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+/*
+	Slice prefetcher
+
+	Draws the slices around the current slice of an axis ahead of time into a slice cache,
+	so stepping through slices presents cached images instead of drawing them.
+
+	Slices in the direction of motion are drawn first, followed by a few behind. Drawing runs at
+	background priority, so it only uses cores left idle by interactive drawing, and a new request
+	abandons the slices of the previous one which have not been started.
+*/
+
+#pragma once
+
+#include <QList>
+#include <QFuture>
+#include <QAtomicInteger>
+
+#include "VolumeRender.h"
+#include "SliceCache.h"
+
+class SlicePrefetcher
+{
+	Q_DISABLE_COPY(SlicePrefetcher)
+
+public:
+
+	/*
+		Construct a prefetcher for an axis of a renderer, drawing into a cache
+	*/
+	SlicePrefetcher(VolumeRender* render, VolumeAxis axis, SliceCache* cache);
+
+	/*
+		Abandons outstanding slices and waits for the slice being drawn
+	*/
+	~SlicePrefetcher();
+
+	/*
+		Number of slices drawn ahead in the direction of motion
+	*/
+	int count() const { return m_count; }
+	void setCount(int count) { m_count = std::max(count, 0); }
+
+	/*
+		Draw slices around an index.
+
+		Direction is the sign of the last change in index, zero if unknown.
+	*/
+	void prefetch(Volume::IndexType index, int direction, quint32 width, quint32 height);
+
+	/*
+		Abandon slices which have not been started
+	*/
+	void cancel();
+
+private:
+
+	//Draw a list of slices, stopping early if the request is superseded
+	void run(const QList<Volume::IndexType>& indices, quint32 width, quint32 height, quint32 request, quint32 generation);
+
+	VolumeRender* m_render;
+	VolumeAxis m_axis;
+	SliceCache* m_cache;
+
+	int m_count = 8;
+
+	//Incremented by every request, running requests stop when it changes
+	QAtomicInteger<quint32> m_request;
+	QList<QFuture<void>> m_running;
+};
@@ -0,0 +1,158 @@
+/*
+	Summed volume table source
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+#include "SummedVolumeTable.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double SummedVolumeTable::Totals::variance() const
+{
+	if (count == 0)
+		return 0.0;
+
+	const double m = mean();
+	return std::max(((double)sumSquares / count) - (m * m), 0.0);
+}
+
+double SummedVolumeTable::Totals::stddev() const
+{
+	return std::sqrt(variance());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SummedVolumeTable::SummedVolumeTable(const Volume* volume)
+{
+	TRACE_SCOPE("buildSummedVolume");
+
+	Q_ASSERT(volume != nullptr);
+
+	const Volume::SizeType sizeX = volume->sizeX();
+	const Volume::SizeType sizeY = volume->sizeY();
+	const Volume::SizeType sizeZ = volume->sizeZ();
+
+	m_size[XAxis] = sizeX;
+	m_size[YAxis] = sizeY;
+	m_size[ZAxis] = sizeZ;
+
+	//The first entry of every axis is zero, so queries need no bounds checks
+	m_pitchY = (size_t)sizeX + 1;
+	m_pitchZ = m_pitchY * ((size_t)sizeY + 1);
+
+	m_sums.assign(m_pitchZ * ((size_t)sizeZ + 1), 0);
+	m_squares.assign(m_sums.size(), 0);
+
+	//Summed area table of every z slice, slices are independent
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(sizeZ), [&](size_t z) {
+
+		TRACE_SCOPE_ARG("summedSlice", z);
+
+		for (Volume::IndexType y = 0; y < sizeY; y++)
+		{
+			const Volume::ElementType* row = volume->data() + volume->index(0, y, (Volume::IndexType)z);
+
+			qint64* sums = &m_sums[index(1, y + 1, (Volume::IndexType)z + 1)];
+			quint64* squares = &m_squares[index(1, y + 1, (Volume::IndexType)z + 1)];
+
+			const qint64* sumsAbove = sums - m_pitchY;
+			const quint64* squaresAbove = squares - m_pitchY;
+
+			//Running total along the row plus the total of the rows above
+			qint64 rowSum = 0;
+			quint64 rowSquares = 0;
+
+			for (Volume::IndexType x = 0; x < sizeX; x++)
+			{
+				const qint32 value = row[x];
+
+				rowSum += value;
+				rowSquares += (quint32)(value * value);
+
+				sums[x] = rowSum + sumsAbove[x];
+				squares[x] = rowSquares + squaresAbove[x];
+			}
+		}
+	});
+
+	//Accumulate slices along z, rows of a slice are independent and each row vectorizes
+	for (Volume::IndexType z = 1; z <= sizeZ; z++)
+	{
+		QtConcurrent::blockingMap(CountingIterator(1), CountingIterator((size_t)sizeY + 1), [&](size_t y) {
+
+			qint64* sums = &m_sums[index(0, (Volume::IndexType)y, z)];
+			quint64* squares = &m_squares[index(0, (Volume::IndexType)y, z)];
+
+			const qint64* sumsBelow = sums - m_pitchZ;
+			const quint64* squaresBelow = squares - m_pitchZ;
+
+			for (size_t x = 1; x < m_pitchY; x++)
+			{
+				sums[x] += sumsBelow[x];
+				squares[x] += squaresBelow[x];
+			}
+		});
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SummedVolumeTable::Totals SummedVolumeTable::box(
+	Volume::IndexType x0, Volume::IndexType y0, Volume::IndexType z0,
+	Volume::IndexType x1, Volume::IndexType y1, Volume::IndexType z1
+) const
+{
+	Totals totals;
+
+	x1 = std::min(x1, m_size[XAxis]);
+	y1 = std::min(y1, m_size[YAxis]);
+	z1 = std::min(z1, m_size[ZAxis]);
+
+	if (x0 >= x1 || y0 >= y1 || z0 >= z1)
+		return totals;
+
+	//Inclusion-exclusion over the corners of the box
+	const size_t corners[8] =
+	{
+		index(x1, y1, z1), index(x0, y0, z1), index(x0, y1, z0), index(x1, y0, z0), //added
+		index(x0, y1, z1), index(x1, y0, z1), index(x1, y1, z0), index(x0, y0, z0)  //subtracted
+	};
+
+	for (int c = 0; c < 4; c++)
+	{
+		totals.sum += m_sums[corners[c]] - m_sums[corners[c + 4]];
+		totals.sumSquares += m_squares[corners[c]] - m_squares[corners[c + 4]];
+	}
+
+	totals.count = (quint64)(x1 - x0) * (y1 - y0) * (z1 - z0);
+
+	return totals;
+}
+
+SummedVolumeTable::Totals SummedVolumeTable::box(const AABB& box) const
+{
+	//First voxel with a centre at or above the minimum, first voxel with a centre above the maximum
+	auto first = [this](float t, VolumeAxis axis) {
+		const float v = std::ceil((t * m_size[axis]) - 0.5f);
+		return (Volume::IndexType)std::min(std::max(v, 0.0f), (float)m_size[axis]);
+	};
+
+	auto last = [this](float t, VolumeAxis axis) {
+		const float v = std::floor((t * m_size[axis]) - 0.5f) + 1.0f;
+		return (Volume::IndexType)std::min(std::max(v, 0.0f), (float)m_size[axis]);
+	};
+
+	return this->box(
+		first(box.min.x(), XAxis), first(box.min.y(), YAxis), first(box.min.z(), ZAxis),
+		last(box.max.x(), XAxis), last(box.max.y(), YAxis), last(box.max.z(), ZAxis)
+	);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
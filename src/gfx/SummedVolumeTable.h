@@ -0,0 +1,71 @@
+/*
+	Summed volume table class:
+
+	The 3D equivalent of a summed area table. Each entry holds the sum of every voxel with lower coordinates,
+	so the sum of any box of voxels is found from the eight entries at its corners, whatever its size.
+	A second table of summed squares gives the variance of the box the same way.
+
+	Entries are 64 bit: a table of 16 bit values squared cannot overflow below 2^33 voxels.
+	The tables have one extra entry along each axis, so take 16 bytes per voxel.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Volume.h"
+#include "RayCasting.h"
+
+class SummedVolumeTable
+{
+public:
+
+	/*
+		Totals of a box of voxels
+	*/
+	struct Totals
+	{
+		quint64 count = 0;
+		qint64 sum = 0;
+		quint64 sumSquares = 0;
+
+		double mean() const { return (count > 0) ? ((double)sum / count) : 0.0; }
+		double variance() const;
+		double stddev() const;
+	};
+
+	SummedVolumeTable() {}
+
+	/*
+		Build the tables of a volume
+	*/
+	explicit SummedVolumeTable(const Volume* volume);
+
+	/*
+		Totals of the voxels in the half open box [x0, x1) * [y0, y1) * [z0, z1)
+	*/
+	Totals box(
+		Volume::IndexType x0, Volume::IndexType y0, Volume::IndexType z0,
+		Volume::IndexType x1, Volume::IndexType y1, Volume::IndexType z1
+	) const;
+
+	/*
+		Totals of the voxels with centres inside a box in normalized volume coordinates
+	*/
+	Totals box(const AABB& box) const;
+
+private:
+
+	//Index of an entry, coordinates are one past the voxels summed
+	size_t index(Volume::IndexType x, Volume::IndexType y, Volume::IndexType z) const
+	{
+		return (size_t)x + (m_pitchY * y) + (m_pitchZ * z);
+	}
+
+	Volume::SizeType m_size[3] = { 0, 0, 0 };
+	size_t m_pitchY = 0;
+	size_t m_pitchZ = 0;
+
+	std::vector<qint64> m_sums;
+	std::vector<quint64> m_squares;
+};
@@ -33,6 +33,21 @@ Volume::Volume(QIODevice& volumeData, const Dimensions& dimensions) :
 	m_max = *minmax.second;
 }
 
+Volume::Volume(const Dimensions& dimensions, QVector<ElementType> data) :
+	m_dim(dimensions),
+	m_data(std::move(data))
+{
+	Q_ASSERT(sizeX() > 0);
+	Q_ASSERT(sizeY() > 0);
+	Q_ASSERT(sizeZ() > 0);
+	Q_ASSERT((SizeType)m_data.size() == sizeX() * sizeY() * sizeZ());
+
+	//Compute minimum and maximum voxels
+	auto minmax = std::minmax_element(begin(), end());
+	m_min = *minmax.first;
+	m_max = *minmax.second;
+}
+
 Volume::Volume(Volume&& other) :
 	m_dim(other.m_dim),
 	m_data(std::move(other.m_data)),
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include <QIODevice>
 #include <QVector>
 
@@ -64,15 +66,22 @@ public:
 	Volume() {}
 	//Construct volume from 3D array source
 	Volume(QIODevice& volumeData, const Dimensions& dimensions);
+	//Construct volume from existing voxel data
+	Volume(const Dimensions& dimensions, QVector<ElementType> data);
 	//Copyable
 	Volume(const Volume&) = default;
 	//Moveable
 	Volume(Volume&& volume);
+	//Assignable
+	Volume& operator=(const Volume&) = default;
+	Volume& operator=(Volume&&) = default;
 
 	/*
 		Get dimensions of volume
 	*/
 
+	const Dimensions& dimensions() const { return m_dim; }
+
 	//X: number of columns / width of volume
 	SizeType sizeX() const { return m_dim.sizeX; }
 	//Y: number of rows / height of volume
@@ -129,7 +138,7 @@ public:
 		Q_ASSERT(v < sizeY());
 		Q_ASSERT(w < sizeZ());
 
-		return m_data[u + sizeY() * (v + sizeX() * w)];
+		return m_data[index(u, v, w)];
 	}
 
 	Volume::ElementType& at(IndexType u, IndexType v, IndexType w)
@@ -139,9 +148,26 @@ public:
 		Q_ASSERT(v < sizeY());
 		Q_ASSERT(w < sizeZ());
 
-		return m_data[u + sizeY() * (v + sizeX() * w)];
+		return m_data[index(u, v, w)];
 	}
 
+	/*
+		Compute index into data buffer from voxel coordinates
+	*/
+	IndexType index(IndexType u, IndexType v, IndexType w) const
+	{
+		return u + sizeX() * (v + sizeY() * w);
+	}
+
+	/*
+		Offsets of voxel coordinates into the data buffer, the index of a voxel is the sum of its offsets.
+
+		Samplers read voxels through these, so they also compile against volumes in other layouts (see LayoutVolume).
+	*/
+	size_t offsetX(IndexType x) const { return x; }
+	size_t offsetY(IndexType y) const { return (size_t)y * sizeX(); }
+	size_t offsetZ(IndexType z) const { return (size_t)z * sizeX() * sizeY(); }
+
 	/*
 		Internal data pointer
 	*/
@@ -159,6 +185,17 @@ public:
 	ElementType min() const { return m_min; }
 	ElementType max() const { return m_max; }
 
+	/*
+		Widen the value range reported by min/max to include a given range.
+
+		Volumes which are mapped the same way, such as the frames of a time series, can share one range.
+	*/
+	void widenRange(ElementType min, ElementType max)
+	{
+		m_min = std::min(m_min, min);
+		m_max = std::max(m_max, max);
+	}
+
 private:
 
 	//Volume dimension info
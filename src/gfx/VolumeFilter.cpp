@@ -0,0 +1,380 @@
+/*
+	Volume filter source
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include <QPair>
+#include <QtConcurrentMap>
+
+#include "VolumeFilter.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+enum Constants
+{
+	//Voxels of a row whose medians are found together, sized so the neighbourhoods of a block stay in L1 cache
+	MEDIAN_BLOCK = 64,
+	MEDIAN_SIZE = 27,
+
+	//Largest kernel radius, a Gaussian is cut off at three standard deviations
+	KERNEL_RADIUS_MAX = 32
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Helpers
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Call a function for every z slice, on a pool or on QtConcurrent's global pool
+*/
+static void forEachSlice(Volume::SizeType slices, RenderThreadPool* pool, RenderPriority priority, const std::function<void(size_t)>& body)
+{
+	if (pool != nullptr)
+	{
+		pool->parallelFor(slices, priority, body);
+	}
+	else
+	{
+		QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(slices), body);
+	}
+}
+
+static Volume::IndexType clampIndex(qint64 i, Volume::SizeType size)
+{
+	return (Volume::IndexType)std::min(std::max(i, (qint64)0), (qint64)size - 1);
+}
+
+/*
+	Normalized weights of a separable filter, of odd length centred on the middle weight
+*/
+static std::vector<float> kernel(const VolumeFilter::Options& options)
+{
+	std::vector<float> weights;
+
+	if (options.type == FilterBox)
+	{
+		const int radius = std::min(std::max(options.radius, 0), (int)KERNEL_RADIUS_MAX);
+		weights.assign(2 * radius + 1, 1.0f / (2 * radius + 1));
+	}
+	else
+	{
+		const float sigma = std::max(options.sigma, 0.01f);
+		const int radius = std::min((int)std::ceil(3.0f * sigma), (int)KERNEL_RADIUS_MAX);
+
+		float total = 0.0f;
+
+		for (int i = -radius; i <= radius; i++)
+		{
+			const float w = std::exp(-(float)(i * i) / (2.0f * sigma * sigma));
+			weights.push_back(w);
+			total += w;
+		}
+
+		for (float& w : weights)
+		{
+			w /= total;
+		}
+	}
+
+	return weights;
+}
+
+/*
+	Compare-exchange network leaving the median of 27 values in the middle element.
+
+	Batcher's odd-even merge sort of 27 elements, without the comparators which cannot affect the middle element.
+*/
+static const std::vector<QPair<int, int>>& medianNetwork()
+{
+	static const std::vector<QPair<int, int>> network = []() {
+
+		const int n = MEDIAN_SIZE;
+
+		std::vector<QPair<int, int>> sort;
+
+		for (int p = 1; p < n; p += p)
+		{
+			for (int k = p; k >= 1; k /= 2)
+			{
+				for (int j = k % p; j + k < n; j += 2 * k)
+				{
+					for (int i = 0; i < k && i < n - j - k; i++)
+					{
+						if ((i + j) / (p * 2) == (i + j + k) / (p * 2))
+							sort.push_back(qMakePair(i + j, i + j + k));
+					}
+				}
+			}
+		}
+
+		//Walk backwards from the middle element, keeping comparators touching an element it depends on
+		std::vector<bool> needed(n, false);
+		needed[n / 2] = true;
+
+		std::vector<QPair<int, int>> pruned;
+
+		for (auto it = sort.rbegin(); it != sort.rend(); ++it)
+		{
+			if (needed[it->first] || needed[it->second])
+			{
+				needed[it->first] = true;
+				needed[it->second] = true;
+				pruned.push_back(*it);
+			}
+		}
+
+		std::reverse(pruned.begin(), pruned.end());
+		return pruned;
+	}();
+
+	return network;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Filters
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Separable filter, one pass along each axis.
+
+	X and Y are filtered a slice at a time into a float volume, then Z is filtered a row at a time from it.
+	Every pass accumulates whole rows of weighted voxels, so the inner loops are contiguous multiply-adds.
+*/
+static QVector<Volume::ElementType> separable(const Volume& volume, const std::vector<float>& weights, RenderCounters* counters, RenderThreadPool* pool, RenderPriority priority)
+{
+	const Volume::SizeType sizeX = volume.sizeX();
+	const Volume::SizeType sizeY = volume.sizeY();
+	const Volume::SizeType sizeZ = volume.sizeZ();
+
+	const int taps = (int)weights.size();
+	const int radius = taps / 2;
+
+	const size_t sliceSize = (size_t)sizeX * sizeY;
+
+	QVector<float> planar((int)(sliceSize * sizeZ));
+	QVector<Volume::ElementType> result((int)(sliceSize * sizeZ));
+
+	//Slices are written concurrently, so the vectors are only detached here
+	float* const planarData = planar.data();
+	Volume::ElementType* const resultData = result.data();
+
+	//X and Y passes
+	forEachSlice(sizeZ, pool, priority, [&](size_t z) {
+
+		TRACE_SCOPE_ARG("filterSlice", z);
+
+		//Row padded with repeated edge voxels, and the slice filtered along X
+		std::vector<float> padded(sizeX + 2 * radius);
+		std::vector<float> filteredX(sliceSize, 0.0f);
+
+		for (Volume::IndexType y = 0; y < sizeY; y++)
+		{
+			const Volume::ElementType* row = volume.data() + volume.index(0, y, (Volume::IndexType)z);
+
+			for (int i = 0; i < (int)padded.size(); i++)
+			{
+				padded[i] = row[clampIndex(i - radius, sizeX)];
+			}
+
+			float* out = &filteredX[(size_t)y * sizeX];
+
+			for (int t = 0; t < taps; t++)
+			{
+				const float w = weights[t];
+				const float* src = &padded[t];
+
+				for (Volume::IndexType x = 0; x < sizeX; x++)
+				{
+					out[x] += w * src[x];
+				}
+			}
+		}
+
+		float* slice = planarData + (sliceSize * z);
+
+		for (Volume::IndexType y = 0; y < sizeY; y++)
+		{
+			float* out = slice + ((size_t)y * sizeX);
+			std::fill(out, out + sizeX, 0.0f);
+
+			for (int t = 0; t < taps; t++)
+			{
+				const float w = weights[t];
+				const float* src = &filteredX[(size_t)clampIndex((qint64)y + t - radius, sizeY) * sizeX];
+
+				for (Volume::IndexType x = 0; x < sizeX; x++)
+				{
+					out[x] += w * src[x];
+				}
+			}
+		}
+
+		if (counters != nullptr)
+		{
+			counters->addRow(0, 2 * sliceSize * taps, 0);
+		}
+	});
+
+	//Z pass
+	forEachSlice(sizeZ, pool, priority, [&](size_t z) {
+
+		TRACE_SCOPE_ARG("filterSlice", z);
+
+		std::vector<float> sum(sizeX);
+
+		for (Volume::IndexType y = 0; y < sizeY; y++)
+		{
+			std::fill(sum.begin(), sum.end(), 0.0f);
+
+			for (int t = 0; t < taps; t++)
+			{
+				const float w = weights[t];
+				const float* src = planarData + (sliceSize * clampIndex((qint64)z + t - radius, sizeZ)) + ((size_t)y * sizeX);
+
+				for (Volume::IndexType x = 0; x < sizeX; x++)
+				{
+					sum[x] += w * src[x];
+				}
+			}
+
+			//Weights add up to one, so results stay within the range of the volume
+			Volume::ElementType* out = resultData + volume.index(0, y, (Volume::IndexType)z);
+
+			for (Volume::IndexType x = 0; x < sizeX; x++)
+			{
+				out[x] = (Volume::ElementType)std::lround(sum[x]);
+			}
+		}
+
+		if (counters != nullptr)
+		{
+			counters->addRow(sliceSize, sliceSize * taps, 0);
+		}
+	});
+
+	return result;
+}
+
+/*
+	3x3x3 median filter.
+
+	The neighbourhoods of a block of voxels in a row are gathered into 27 lanes, one per neighbour,
+	then the median network is applied to every lane at once with element-wise min/max.
+*/
+static QVector<Volume::ElementType> median(const Volume& volume, RenderCounters* counters, RenderThreadPool* pool, RenderPriority priority)
+{
+	const Volume::SizeType sizeX = volume.sizeX();
+	const Volume::SizeType sizeY = volume.sizeY();
+	const Volume::SizeType sizeZ = volume.sizeZ();
+
+	const std::vector<QPair<int, int>>& network = medianNetwork();
+
+	QVector<Volume::ElementType> result((int)((size_t)sizeX * sizeY * sizeZ));
+	Volume::ElementType* const resultData = result.data();
+
+	forEachSlice(sizeZ, pool, priority, [&](size_t z) {
+
+		TRACE_SCOPE_ARG("medianSlice", z);
+
+		//Nine neighbouring rows padded with repeated edge voxels
+		std::vector<Volume::ElementType> rows(9 * (sizeX + 2));
+		Volume::ElementType lanes[MEDIAN_SIZE][MEDIAN_BLOCK];
+
+		for (Volume::IndexType y = 0; y < sizeY; y++)
+		{
+			for (int r = 0; r < 9; r++)
+			{
+				const Volume::IndexType ny = clampIndex((qint64)y + (r % 3) - 1, sizeY);
+				const Volume::IndexType nz = clampIndex((qint64)z + (r / 3) - 1, sizeZ);
+
+				const Volume::ElementType* src = volume.data() + volume.index(0, ny, nz);
+				Volume::ElementType* dst = &rows[r * (sizeX + 2)];
+
+				dst[0] = src[0];
+				std::copy(src, src + sizeX, dst + 1);
+				dst[sizeX + 1] = src[sizeX - 1];
+			}
+
+			Volume::ElementType* out = resultData + volume.index(0, y, (Volume::IndexType)z);
+
+			for (Volume::IndexType x0 = 0; x0 < sizeX; x0 += MEDIAN_BLOCK)
+			{
+				const int n = (int)std::min<Volume::SizeType>(MEDIAN_BLOCK, sizeX - x0);
+
+				for (int r = 0; r < 9; r++)
+				{
+					for (int dx = 0; dx < 3; dx++)
+					{
+						const Volume::ElementType* src = &rows[r * (sizeX + 2) + x0 + dx];
+						std::copy(src, src + n, lanes[r * 3 + dx]);
+					}
+				}
+
+				for (const QPair<int, int>& c : network)
+				{
+					Volume::ElementType* a = lanes[c.first];
+					Volume::ElementType* b = lanes[c.second];
+
+					for (int i = 0; i < n; i++)
+					{
+						const Volume::ElementType lo = std::min(a[i], b[i]);
+						const Volume::ElementType hi = std::max(a[i], b[i]);
+						a[i] = lo;
+						b[i] = hi;
+					}
+				}
+
+				std::copy(lanes[MEDIAN_SIZE / 2], lanes[MEDIAN_SIZE / 2] + n, out + x0);
+			}
+		}
+
+		if (counters != nullptr)
+		{
+			counters->addRow((quint64)sizeX * sizeY, (quint64)sizeX * sizeY * MEDIAN_SIZE, 0);
+		}
+	});
+
+	return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Volume VolumeFilter::apply(const Volume& volume, const Options& options, RenderCounters* counters, RenderThreadPool* pool, RenderPriority priority)
+{
+	TRACE_SCOPE("filterVolume");
+
+	QVector<Volume::ElementType> data;
+
+	if (options.type == FilterMedian)
+	{
+		data = median(volume, counters, pool, priority);
+	}
+	else
+	{
+		data = separable(volume, kernel(options), counters, pool, priority);
+	}
+
+	return Volume(volume.dimensions(), std::move(data));
+}
+
+QStringList VolumeFilter::typeNames()
+{
+	return { QStringLiteral("gaussian"), QStringLiteral("box"), QStringLiteral("median") };
+}
+
+bool VolumeFilter::parseType(const QString& name, FilterType& type)
+{
+	const int index = typeNames().indexOf(name.trimmed().toLower());
+
+	if (index < 0)
+		return false;
+
+	type = (FilterType)index;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,73 @@
+/*
+	Volume filters
+
+	Produce a new volume from an existing one, for example to smooth the noise of a low-dose scan before projecting it.
+
+	Gaussian:
+		Separable Gaussian blur of a given standard deviation in voxels
+
+	Box:
+		Separable mean of a cube of voxels of a given radius
+
+	Median:
+		Median of the 3x3x3 neighbourhood of each voxel, removes speckle while keeping edges
+
+	Voxels beyond the edges of the volume repeat the nearest edge voxel.
+	Slabs of z slices are filtered in parallel, and every inner loop runs along a row of voxels so it vectorizes.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "Volume.h"
+#include "RenderStatistics.h"
+#include "RenderThreadPool.h"
+
+enum FilterType
+{
+	FilterGaussian,
+	FilterBox,
+	FilterMedian
+};
+
+class VolumeFilter
+{
+public:
+
+	struct Options
+	{
+		FilterType type = FilterGaussian;
+
+		//Standard deviation of the Gaussian filter in voxels
+		float sigma = 1.0f;
+
+		//Radius of the box filter in voxels
+		int radius = 1;
+	};
+
+	/*
+		Filter a volume.
+
+		Optionally voxels written are counted as pixels and voxels read as samples.
+		Slabs run on the given thread pool at the given priority, or on QtConcurrent's global pool if no pool is given.
+	*/
+	static Volume apply(
+		const Volume& volume,
+		const Options& options,
+		RenderCounters* counters = nullptr,
+		RenderThreadPool* pool = nullptr,
+		RenderPriority priority = PriorityBackground
+	);
+
+	/*
+		Names of filter types, indexed by type
+	*/
+	static QStringList typeNames();
+
+	/*
+		Parse a filter type from its name, returns false if the name is unknown
+	*/
+	static bool parseType(const QString& name, FilterType& type);
+};
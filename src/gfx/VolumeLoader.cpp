@@ -0,0 +1,124 @@
+/*
+	Volume loader source
+*/
+
+#include <QSettings>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+#include "VolumeLoader.h"
+#include "util/Trace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VolumeLoader::readConfig(const QString& configPath, Volume::Dimensions& dimensions, QString& datasetPath, QString* error)
+{
+	if (!QFileInfo(configPath).exists())
+	{
+		if (error != nullptr)
+			*error = QStringLiteral("Config file not found: ") + configPath;
+
+		return false;
+	}
+
+	QSettings config(configPath, QSettings::IniFormat);
+
+	//Get volume dimensions from config
+	dimensions.sizeX = config.value("Application/sizeX", 0).toInt();
+	dimensions.sizeY = config.value("Application/sizeY", 0).toInt();
+	dimensions.sizeZ = config.value("Application/sizeZ", 0).toInt();
+
+	dimensions.scaleX = config.value("Application/scaleX", 1).toInt();
+	dimensions.scaleY = config.value("Application/scaleY", 1).toInt();
+	dimensions.scaleZ = config.value("Application/scaleZ", 1).toInt();
+
+	if (dimensions.sizeX == 0 || dimensions.sizeY == 0 || dimensions.sizeZ == 0)
+	{
+		if (error != nullptr)
+			*error = QStringLiteral("Invalid volume dimensions in ") + configPath;
+
+		return false;
+	}
+
+	//Dataset is relative to the config file
+	datasetPath = QFileInfo(configPath).dir().filePath(config.value("Application/dataset").toString());
+
+	return true;
+}
+
+bool VolumeLoader::load(const QString& configPath, Volume& volume, QString* error)
+{
+	TRACE_SCOPE("loadVolume");
+
+	Volume::Dimensions dimensions;
+	QString datasetPath;
+
+	if (!readConfig(configPath, dimensions, datasetPath, error))
+		return false;
+
+	//Try read volume data file
+	QFile file(datasetPath);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		if (error != nullptr)
+			*error = file.errorString();
+
+		return false;
+	}
+
+	if (file.size() < (qint64)(dimensions.sizeX * dimensions.sizeY * dimensions.sizeZ * sizeof(Volume::ElementType)))
+	{
+		if (error != nullptr)
+			*error = QStringLiteral("Dataset is smaller than the configured dimensions: ") + datasetPath;
+
+		return false;
+	}
+
+	volume = Volume(file, dimensions);
+
+	return true;
+}
+
+bool VolumeLoader::save(const QString& configPath, const Volume& volume, QString* error)
+{
+	TRACE_SCOPE("saveVolume");
+
+	const QFileInfo configInfo(configPath);
+	const QString datasetName = configInfo.completeBaseName() + QStringLiteral(".raw");
+
+	QFile file(configInfo.dir().filePath(datasetName));
+
+	const qint64 bytes = (qint64)volume.sizeX() * volume.sizeY() * volume.sizeZ() * sizeof(Volume::ElementType);
+
+	if (!file.open(QIODevice::WriteOnly) || file.write((const char*)volume.data(), bytes) != bytes)
+	{
+		if (error != nullptr)
+			*error = file.errorString();
+
+		return false;
+	}
+
+	QSettings config(configPath, QSettings::IniFormat);
+	config.setValue("Application/dataset", datasetName);
+	config.setValue("Application/sizeX", volume.sizeX());
+	config.setValue("Application/sizeY", volume.sizeY());
+	config.setValue("Application/sizeZ", volume.sizeZ());
+	config.setValue("Application/scaleX", volume.scaleX());
+	config.setValue("Application/scaleY", volume.scaleY());
+	config.setValue("Application/scaleZ", volume.scaleZ());
+	config.sync();
+
+	if (config.status() != QSettings::NoError)
+	{
+		if (error != nullptr)
+			*error = QStringLiteral("Could not write ") + configPath;
+
+		return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
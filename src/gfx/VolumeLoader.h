@@ -0,0 +1,41 @@
+/*
+	Volume loader
+
+	Loads a volume described by a config file:
+
+	[Application]
+	dataset="CThead"  ; raw 16 bit voxel file, relative paths are relative to the config file
+	sizeX=256         ; dimensions in voxels
+	sizeY=256
+	sizeZ=113
+	scaleX=1          ; voxel scale factors
+	scaleY=1
+	scaleZ=2
+	timePoints=1      ; optional number of frames of a time series, see VolumeSeries
+*/
+
+#pragma once
+
+#include <QString>
+
+#include "Volume.h"
+
+class VolumeLoader
+{
+public:
+
+	/*
+		Read the volume dimensions and dataset path from a config file
+	*/
+	static bool readConfig(const QString& configPath, Volume::Dimensions& dimensions, QString& datasetPath, QString* error = nullptr);
+
+	/*
+		Load the volume described by a config file
+	*/
+	static bool load(const QString& configPath, Volume& volume, QString* error = nullptr);
+
+	/*
+		Save a volume as a raw dataset next to a config file describing it, so it can be loaded again
+	*/
+	static bool save(const QString& configPath, const Volume& volume, QString* error = nullptr);
+};
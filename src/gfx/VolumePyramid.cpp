@@ -0,0 +1,102 @@
+/*
+	Volume pyramid source
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+#include "VolumePyramid.h"
+#include "VolumeSubimage.h"
+#include "util/CountingIterator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VolumePyramid::VolumePyramid(const Volume* volume, VolumeAxis axis) :
+	m_volume(volume),
+	m_axis(axis)
+{
+	Q_ASSERT(volume != nullptr);
+
+	const Volume* source = volume;
+
+	//Halve subimage dimensions until a single texel is left
+	while (VolumeSubimage(source, 0, axis).width() > 1 || VolumeSubimage(source, 0, axis).height() > 1)
+	{
+		m_levels.append(downsample(*source, axis));
+		source = &m_levels.last();
+	}
+}
+
+Volume::SizeType VolumePyramid::selectLevel(float minification) const
+{
+	if (minification < 2.0f)
+		return 0;
+
+	const Volume::SizeType level = (Volume::SizeType)std::floor(std::log2(minification));
+
+	return std::min(level, levels() - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Volume VolumePyramid::downsample(const Volume& source, VolumeAxis axis)
+{
+	const VolumeSubimage first(&source, 0, axis);
+
+	//Subimage dimensions of source and destination
+	const Volume::SizeType srcWidth = first.width();
+	const Volume::SizeType srcHeight = first.height();
+	const Volume::SizeType dstWidth = (srcWidth + 1) / 2;
+	const Volume::SizeType dstHeight = (srcHeight + 1) / 2;
+
+	//Volume dimensions of destination, only the subimage plane is reduced
+	Volume::Dimensions dim = source.dimensions();
+
+	switch (axis)
+	{
+	case XAxis: dim.sizeY = dstWidth; dim.sizeZ = dstHeight; dim.scaleY *= 2; dim.scaleZ *= 2; break;
+	case YAxis: dim.sizeX = dstWidth; dim.sizeZ = dstHeight; dim.scaleX *= 2; dim.scaleZ *= 2; break;
+	case ZAxis: dim.sizeX = dstWidth; dim.sizeY = dstHeight; dim.scaleX *= 2; dim.scaleY *= 2; break;
+	}
+
+	QVector<Volume::ElementType> data(dim.sizeX * dim.sizeY * dim.sizeZ);
+	Volume::ElementType* dst = data.data();
+
+	//Index weights of destination subimage uv's, matching the layout of VolumeSubimage
+	const Volume::SizeType weights[3] = { 1, dim.sizeX, dim.sizeX * dim.sizeY };
+	const Volume::SizeType planeAxes[3][2] = { { 1, 2 }, { 0, 2 }, { 0, 1 } };
+
+	const Volume::SizeType uWeight = weights[planeAxes[axis][0]];
+	const Volume::SizeType vWeight = weights[planeAxes[axis][1]];
+	const Volume::SizeType idxWeight = weights[axis];
+
+	//Slices are independent so they can be filtered concurrently
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(source.axisSize(axis)), [&](size_t index) {
+
+		const VolumeSubimage src(&source, (Volume::IndexType)index, axis);
+
+		for (Volume::IndexType v = 0; v < dstHeight; v++)
+		{
+			//Clamp texels at odd edges
+			const Volume::IndexType v0 = v * 2;
+			const Volume::IndexType v1 = std::min(v0 + 1, srcHeight - 1);
+
+			for (Volume::IndexType u = 0; u < dstWidth; u++)
+			{
+				const Volume::IndexType u0 = u * 2;
+				const Volume::IndexType u1 = std::min(u0 + 1, srcWidth - 1);
+
+				//2x2 box filter
+				const int sum = src.at(u0, v0) + src.at(u1, v0) + src.at(u0, v1) + src.at(u1, v1);
+
+				dst[(index * idxWeight) + (u * uWeight) + (v * vWeight)] = (Volume::ElementType)(sum / 4);
+			}
+		}
+	});
+
+	return Volume(dim, std::move(data));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
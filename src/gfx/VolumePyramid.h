@@ -0,0 +1,62 @@
+/*
+	Volume pyramid class:
+
+	Stores a chain of successively downsampled copies of a volume for the subimages of one axis.
+
+	Each level halves the two dimensions in the plane of the subimages using a 2x2 box filter,
+	the dimension along the axis is left unchanged so every slice keeps its index.
+	Minified subimages can then be drawn from a prefiltered level instead of point sampling the full resolution slice.
+*/
+
+#pragma once
+
+#include "Volume.h"
+
+class VolumePyramid
+{
+public:
+
+	VolumePyramid() {}
+
+	/*
+		Build all the levels of a volume for a given axis
+	*/
+	VolumePyramid(const Volume* volume, VolumeAxis axis);
+
+	/*
+		Number of levels, including the source volume
+	*/
+	Volume::SizeType levels() const { return (Volume::SizeType)m_levels.size() + 1; }
+
+	/*
+		Fetch a level, level 0 is the source volume
+	*/
+	const Volume* level(Volume::SizeType i) const
+	{
+		Q_ASSERT(i < levels());
+		return (i == 0) ? m_volume : &m_levels[(int)i - 1];
+	}
+
+	/*
+		Choose the level to draw subimages from, for a given ratio between subimage size and output size.
+
+		The largest level which is still at least as big as the output is chosen.
+	*/
+	Volume::SizeType selectLevel(float minification) const;
+
+	/*
+		Axis the pyramid was built for
+	*/
+	VolumeAxis axis() const { return m_axis; }
+
+private:
+
+	//Downsample a level in the plane of the axis
+	static Volume downsample(const Volume& source, VolumeAxis axis);
+
+	const Volume* m_volume = nullptr;
+	VolumeAxis m_axis = ZAxis;
+
+	//Downsampled levels 1..n
+	QVector<Volume> m_levels;
+};
@@ -3,6 +3,7 @@
 */
 
 #include <QElapsedTimer>
+#include <QtConcurrentRun>
 
 //#define NO_PARALLEL_PIXEL_FUNC
 
@@ -11,6 +12,7 @@
 #include "Samplers.h"
 #include "ImageDrawer.h"
 #include "RayCasting.h"
+#include "util/Trace.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Constructor
@@ -21,6 +23,7 @@ VolumeRender::VolumeRender(Volume& volume, QObject* parent) :
 	m_volume(std::move(volume)),
 	m_histogramMapper(&m_volume),
 	m_simpleMapper(&m_volume),
+	m_adaptiveMapper(&m_volume),
 	m_sampleFrequency(125)
 {
 	//Set default colour mapping table
@@ -29,44 +32,442 @@ VolumeRender::VolumeRender(Volume& volume, QObject* parent) :
 	//Set default sampling functions
 	setSamplingTypeBilinear();   //2D
 	setSamplingTypeTrilinear();  //3D
+
+	connect(&m_isotropicBuild, &QFutureWatcher<Volume>::finished, this, &VolumeRender::installIsotropic);
+	connect(&m_statisticsBuild, &QFutureWatcher<std::shared_ptr<const VolumeStatistics>>::finished, this, &VolumeRender::installStatistics);
+	connect(&m_equalizerBuild, &QFutureWatcher<std::shared_ptr<EqualizerTables>>::finished, this, &VolumeRender::installEqualizers);
+}
+
+VolumeRender::~VolumeRender()
+{
+	//Statistics are built on the thread pool, which is destroyed with the renderer
+	m_statisticsBuild.waitForFinished();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Drawing functions
+// Helpers
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void VolumeRender::drawSubimage(ImageBuffer& target, Volume::IndexType index, VolumeAxis axis)
+/*
+	Convert subimage uv's to normalized volume coordinates
+*/
+static UVW subimageToVolume(const UV& coords, Volume::IndexType index, VolumeAxis axis, const Volume& volume)
 {
-	VolumeSubimage view(&m_volume, index, axis);
+	//Normalized position of slice centre along the axis
+	const float w = ((float)index + 0.5f) / volume.axisSize(axis);
+
+	switch (axis)
+	{
+	case XAxis: return UVW(w, coords.u, coords.v);
+	case YAxis: return UVW(coords.u, w, coords.v);
+	default:    return UVW(coords.u, coords.v, w);
+	}
+}
+
+VolumeRender::SubimageSource VolumeRender::subimageSource(VolumeAxis axis, const ImageBuffer& target, RenderCounters& counters)
+{
+	//Slices of an axis with a scale of one have the same indices in the isotropic copy
+	const Volume* base = (m_isotropic.sizeX() > 0 && m_volume.axisScale(axis) == 1) ? &m_isotropic : &m_volume;
+
+	SubimageSource source = { base, axis };
+
+	//Slices of X and Y are drawn as the contiguous Z slices of a transposed replica
+	if (axis != ZAxis && replicaFits(axis, *base))
+	{
+		if (m_replicas[axis].ready())
+		{
+			counters.addCacheHit();
+		}
+
+		source.volume = &m_replicas[axis].get([&]() {
+			return VolumeReplica::transpose(*base, axis);
+		});
+
+		source.axis = ZAxis;
+	}
+
+	if (target.width() == 0 || target.height() == 0)
+		return source;
+
+	//Ratio of subimage texels to target pixels, taken from the axis which shrinks least
+	//so no axis of the chosen level is smaller than the output, as with scaled slices of anisotropic volumes
+	const VolumeSubimage view(source.volume, 0, source.axis);
+	const float minification = std::min((float)view.width() / target.width(), (float)view.height() / target.height());
 
-	ImageDrawer::dispatch(target, [&](UV coords) {
-		return m_mapper->normalize(m_samplerFunc(view, coords));
+	//Magnified or near full size subimages are sampled directly
+	if (minification < 2.0f)
+		return source;
+
+	if (m_pyramids[axis].ready())
+	{
+		counters.addCacheHit();
+	}
+
+	//Minified subimages are drawn from a prefiltered level
+	const VolumePyramid& pyramid = m_pyramids[axis].get([&]() {
+		TRACE_SCOPE_ARG("buildPyramid", axis);
+		return VolumePyramid(source.volume, source.axis);
 	});
+
+	source.volume = pyramid.level(pyramid.selectLevel(minification));
+	return source;
+}
+
+bool VolumeRender::replicaFits(VolumeAxis axis, const Volume& volume) const
+{
+	const quint64 bytes = VolumeReplica::bytes(volume);
+	return bytes * ((axis == XAxis) ? 1 : 2) <= m_replicaBudget;
 }
 
-void VolumeRender::drawSubimageMIP(ImageBuffer& target, VolumeAxis axis)
+void VolumeRender::resetSubimageSources()
 {
-	//Construct a range over the given axis
-	VolumeSubimageRange range(&m_volume, axis);
+	for (Lazy<VolumePyramid>& pyramid : m_pyramids)
+	{
+		pyramid.reset();
+	}
+
+	for (Lazy<Volume>& replica : m_replicas)
+	{
+		replica.reset();
+	}
+}
+
+SamplerFunc2D VolumeRender::subimageSampler(RenderQuality quality) const
+{
+	//Previews use the cheapest sampler
+	if (quality == QualityPreview)
+	{
+		const SamplerFunc2D basic = &BasicSampler::sample;
+		return basic;
+	}
+
+	return m_samplerFunc;
+}
+
+std::shared_ptr<const VolumeStatistics> VolumeRender::volumeStatistics()
+{
+	if (m_statisticsStale)
+	{
+		buildStatistics();
+	}
+
+	return m_volumeStatistics;
+}
+
+const SummedVolumeTable& VolumeRender::summedVolume()
+{
+	QReadLocker lock(&m_volumeLock);
+
+	return m_summedVolume.get([&]() {
+		return SummedVolumeTable(&m_volume);
+	});
+}
+
+RenderStats VolumeRender::record(RenderCall call, const RenderCounters& counters, qint64 wallTimeNs)
+{
+	const RenderStats stats = counters.stats(wallTimeNs);
+
+	QMutexLocker lock(&m_statsMutex);
+	m_statistics[call].add(stats);
+
+	return stats;
+}
+
+RenderStatistics VolumeRender::statistics(RenderCall call) const
+{
+	QMutexLocker lock(&m_statsMutex);
+	return m_statistics[call];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Drawing functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderStats VolumeRender::drawSubimage(ImageBuffer& target, Volume::IndexType index, VolumeAxis axis, RenderPriority priority, const QRect& region, RenderQuality quality)
+{
+	TRACE_SCOPE_ARG("drawSubimage", index);
+
+	QReadLocker volumeLock(&m_volumeLock);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	RenderCounters counters;
+	const SubimageSource source = subimageSource(axis, target, counters);
+	VolumeSubimage view(source.volume, index, source.axis);
+	const SamplerFunc2D sampler = subimageSampler(quality);
+
+	if (m_adaptive)
+	{
+		ImageDrawer::dispatch(target, [&](UV coords) {
+			ImageDrawer::countSamples(1);
+			const UVW pos = subimageToVolume(coords, index, axis, m_volume);
+			return m_adaptiveMapper.normalize(sampler(view, coords), pos.u, pos.v, pos.w);
+		}, &counters, &m_pool, priority, region);
+	}
+	else
+	{
+		ImageDrawer::dispatch(target, [&](UV coords) {
+			ImageDrawer::countSamples(1);
+			return m_mapper->normalize(sampler(view, coords));
+		}, &counters, &m_pool, priority, region);
+	}
+
+	return record(RenderSubimage, counters, timer.nsecsElapsed());
+}
+
+RenderStats VolumeRender::drawSubimageMIP(ImageBuffer& target, VolumeAxis axis, RenderPriority priority, const QRect& region, RenderQuality quality)
+{
+	TRACE_SCOPE_ARG("drawSubimageMIP", axis);
+
+	QReadLocker volumeLock(&m_volumeLock);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	RenderCounters counters;
+
+	const SubimageSource source = subimageSource(axis, target, counters);
+	const SamplerFunc2D sampler = subimageSampler(quality);
+	const float depth = (float)m_volume.axisSize(axis);
+
+	//Direction of the projection in volume coordinates
+	QVector3D direction;
+	direction[axis] = 1.0f;
 
 	//Draw using MIP
 	ImageDrawer::dispatch(target, [&](UV coords)
 	{
 		Volume::ElementType max = std::numeric_limits<Volume::ElementType>::min();
+		Volume::IndexType maxIndex = 0;
+
+		//Part of the projection line inside the clip region, as normalized positions along the axis
+		QVector3D origin = subimageToVolume(coords, 0, axis, m_volume).toVector();
+		origin[axis] = 0.0f;
+
+		float w0 = 0.0f;
+		float w1 = 1.0f;
+
+		if (!m_clip.clip(Ray(origin, direction), w0, w1))
+		{
+			ImageDrawer::countSkipped(1);
+			return m_mapper->normalize(max);
+		}
 
-		//Iterate over every slice
-		for (const VolumeSubimage& view : range)
+		//Slices whose centres lie inside the clipped interval
+		const auto first = (Volume::IndexType)std::max(ceilf(w0 * depth - 0.5f), 0.0f);
+		const auto last = (Volume::IndexType)std::min(floorf(w1 * depth - 0.5f) + 1.0f, depth);
+
+		if (first >= last)
+		{
+			ImageDrawer::countSkipped(1);
+			return m_mapper->normalize(max);
+		}
+
+		ImageDrawer::countSamples(last - first);
+
+		//Iterate over every slice in the region
+		for (const VolumeSubimage& view : VolumeSubimageRange(source.volume, source.axis, first, last))
 		{
 			//Override max if sampled value is greater
-			max = std::max(max, m_samplerFunc(view, coords));
+			const Volume::ElementType value = sampler(view, coords);
+
+			if (value > max)
+			{
+				max = value;
+				maxIndex = view.index();
+			}
+		}
+
+		if (m_adaptive)
+		{
+			//Map using the tiles surrounding the voxel of maximum intensity
+			const UVW pos = subimageToVolume(coords, maxIndex, axis, m_volume);
+			return m_adaptiveMapper.normalize(max, pos.u, pos.v, pos.w);
 		}
 
 		return m_mapper->normalize(max);
-	});
+	}, &counters, &m_pool, priority, region);
+
+	return record(RenderSubimageMIP, counters, timer.nsecsElapsed());
 }
 
-void VolumeRender::draw3D(ImageBuffer& target, const QMatrix4x4& modelView)
+/*
+	Draw one row of an oblique slice.
+
+	Sample positions are walked along the row in voxel coordinates by adding a fixed step,
+	the plane is not evaluated again for each pixel.
+*/
+template<typename Sampler, typename Mapper>
+static void drawObliqueRow(quint8* row, quint32 begin, quint32 end, const QVector3D& pos, const QVector3D& step, const Volume& volume, const Mapper& map)
 {
+	float x = pos.x(), y = pos.y(), z = pos.z();
+	const float dx = step.x(), dy = step.y(), dz = step.z();
+
+	for (quint32 i = begin; i < end; i++)
+	{
+		row[i] = map(Sampler::sampleVoxel(volume, x, y, z), x, y, z);
+
+		x += dx;
+		y += dy;
+		z += dz;
+	}
+}
+
+RenderStats VolumeRender::drawOblique(ImageBuffer& target, const ObliqueSlice& slice, RenderPriority priority, const QRect& region)
+{
+	TRACE_SCOPE("drawOblique");
+
+	QReadLocker volumeLock(&m_volumeLock);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	RenderCounters counters;
+
+	const Volume& volume = sampledVolume();
+
+	//Plane in voxel coordinates, voxel centres lie on whole numbers
+	const QVector3D size((float)volume.sizeX(), (float)volume.sizeY(), (float)volume.sizeZ());
+	const QVector3D origin = (slice.origin() * size) - QVector3D(0.5f, 0.5f, 0.5f);
+	const QVector3D uStep = (slice.uAxis() * size) / (float)std::max(target.width(), 1u);
+	const QVector3D vStep = (slice.vAxis() * size) / (float)std::max(target.height(), 1u);
+
+	//Colour mapping of a sample at voxel coordinates
+	auto mapGlobal = [&](Volume::ElementType value, float, float, float) {
+		return m_mapper->normalize(value);
+	};
+
+	auto mapAdaptive = [&](Volume::ElementType value, float x, float y, float z) {
+		return m_adaptiveMapper.normalize(value, (x + 0.5f) / size.x(), (y + 0.5f) / size.y(), (z + 0.5f) / size.z());
+	};
+
+	const bool trilinear = (getSamplingType3D() == SamplingTrilinear);
+
+	ImageDrawer::dispatchRows<quint8>(target, [&](quint8* row, quint32 j, quint32 begin, quint32 end) {
+
+		ImageDrawer::countSamples(end - begin);
+
+		//Position of the first pixel of the row
+		const QVector3D pos = origin + (vStep * (float)j) + (uStep * (float)begin);
+
+		//Choose the sampler and mapper once per row
+		if (trilinear)
+		{
+			if (m_adaptive)
+				drawObliqueRow<TrilinearSampler>(row, begin, end, pos, uStep, volume, mapAdaptive);
+			else
+				drawObliqueRow<TrilinearSampler>(row, begin, end, pos, uStep, volume, mapGlobal);
+		}
+		else
+		{
+			if (m_adaptive)
+				drawObliqueRow<BasicSampler>(row, begin, end, pos, uStep, volume, mapAdaptive);
+			else
+				drawObliqueRow<BasicSampler>(row, begin, end, pos, uStep, volume, mapGlobal);
+		}
+
+	}, &counters, &m_pool, priority, region);
+
+	return record(RenderOblique, counters, timer.nsecsElapsed());
+}
+
+/*
+	Cast one ray of the 3D view, returning the maximum intensity along it.
+
+	Samples are taken at voxel coordinates, from a volume in any layout.
+	Blocks which cannot raise the maximum are stepped over, and voxels outside a non-empty mask are not shown.
+*/
+template<typename Sampler, typename VolumeType>
+static Volume::ElementType marchRay(const VolumeType& volume, const MacrocellGrid& cells, const LabelMask& mask, const RaycastResult& raycast, Volume::ElementType max)
+{
+	const QVector3D size((float)volume.sizeX(), (float)volume.sizeY(), (float)volume.sizeZ());
+	const QVector3D offset(0.5f, 0.5f, 0.5f);
+
+	const QVector3D step = raycast.stepVector();
+	const int count = raycast.samples();
+
+	const bool masked = !mask.isEmpty();
+
+	quint64 samples = 0;
+
+	//Traverse volume along ray
+	for (int i = 0; i < count;)
+	{
+		const QVector3D pos = raycast.start() + (step * (float)i);
+
+		//Blocks which cannot raise the maximum are stepped over without sampling
+		int x, y, z;
+		cells.cellAt(pos, x, y, z);
+
+		if (cells.max(x, y, z) <= max)
+		{
+			i += cells.stepsToExit(pos, step, x, y, z);
+			continue;
+		}
+
+		//Voxels outside the segmented region are not shown
+		if (masked && !mask.contains(pos))
+		{
+			i++;
+			continue;
+		}
+
+		//Maximum intensity projection, voxel centres lie on whole numbers
+		const QVector3D voxel = (pos * size) - offset;
+
+		max = std::max(max, Sampler::sampleVoxel(volume, voxel.x(), voxel.y(), voxel.z()));
+		samples++;
+		i++;
+	}
+
+	ImageDrawer::countSamples(samples);
+
+	return max;
+}
+
+RenderStats VolumeRender::draw3D(ImageBuffer& target, const QMatrix4x4& modelView, RenderPriority priority)
+{
+	TRACE_SCOPE("draw3D");
+
+	QReadLocker volumeLock(&m_volumeLock);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	RenderCounters counters;
+
+	if (m_macrocells.ready())
+	{
+		counters.addCacheHit();
+	}
+
+	const Volume& volume = sampledVolume();
+
+	//Block maxima of the sampled volume, shared by every frame
+	//Taken from the isotropic copy when it is sampled, as cubic resampling can overshoot the maxima of the original
+	const MacrocellGrid& cells = m_macrocells.get([&]() {
+		TRACE_SCOPE("buildMacrocells");
+		return MacrocellGrid(&volume);
+	});
+
+	//Copy of the volume in a locality preserving layout, shared by every frame
+	const LayoutVolume* layout = nullptr;
+
+	if (m_layout3D != LayoutLinear)
+	{
+		if (m_layoutVolume.ready())
+		{
+			counters.addCacheHit();
+		}
+
+		layout = &m_layoutVolume.get([&]() {
+			return LayoutVolume(volume, m_layout3D);
+		});
+	}
+
+	const bool trilinear = (getSamplingType3D() == SamplingTrilinear);
+
 	ImageDrawer::dispatch(target, [&](UV coord)->quint8 {
 
 		const QVector3D offset(0.5f, 0.5f, 0.5f);
@@ -84,31 +485,333 @@ void VolumeRender::draw3D(ImageBuffer& target, const QMatrix4x4& modelView)
 		ray.dir = modelView * ray.dir;
 		ray.dir.normalize();
 
-		//Default
-		Volume::ElementType max = m_volume.min();
-
-		//Perform ray cast into volume
+		//Perform ray cast into the region of interest
 		RaycastResult raycast = Raycast::intersects(
-			AABB(QVector3D(0.0f, 0.0f, 0.0f), QVector3D(1.0f, 1.0f, 1.0f)),
+			m_clip.box(),
+			m_clip.planes(),
 			ray,
 			m_sampleFrequency
 		);
 
-		//Traverse volume along ray
-		for (const QVector3D& pos : raycast)
+		//Rays missing the volume are not sampled
+		if (!raycast)
+		{
+			ImageDrawer::countSkipped(1);
+		}
+
+		//Default
+		Volume::ElementType max = m_volume.min();
+
+		//Choose the sampler and layout once per ray
+		if (layout != nullptr)
 		{
-			//Maximum intensity projection
-			max = std::max(max, m_samplerFunc3D(m_volume, pos));
+			if (trilinear)
+				max = marchRay<TrilinearSampler>(*layout, cells, m_mask, raycast, max);
+			else
+				max = marchRay<BasicSampler>(*layout, cells, m_mask, raycast, max);
+		}
+		else
+		{
+			if (trilinear)
+				max = marchRay<TrilinearSampler>(volume, cells, m_mask, raycast, max);
+			else
+				max = marchRay<BasicSampler>(volume, cells, m_mask, raycast, max);
 		}
 
 		return m_simpleMapper.normalize(max);
-	});
+	}, &counters, &m_pool, priority);
+
+	return record(Render3D, counters, timer.nsecsElapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderStats VolumeRender::growRegion(Volume::IndexType x, Volume::IndexType y, Volume::IndexType z, const RegionGrowing::Options& options, RenderPriority priority)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	RenderCounters counters;
+	LabelMask mask;
+
+	{
+		QReadLocker volumeLock(&m_volumeLock);
+		mask = RegionGrowing::grow(m_volume, x, y, z, options, &counters, &m_pool, priority);
+	}
+
+	const RenderStats stats = counters.stats(timer.nsecsElapsed());
+
+	setMask(mask);
+
+	return stats;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Render states
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void VolumeRender::setVolume(const Volume& volume)
+{
+	TRACE_SCOPE("setVolume");
+
+	Q_ASSERT(volume.sizeX() == m_volume.sizeX());
+	Q_ASSERT(volume.sizeY() == m_volume.sizeY());
+	Q_ASSERT(volume.sizeZ() == m_volume.sizeZ());
+
+	{
+		QWriteLocker lock(&m_volumeLock);
+
+		const Volume::ElementType min = m_volume.min();
+		const Volume::ElementType max = m_volume.max();
+
+		m_volume = volume;
+
+		//Successive volumes share the widest value range seen so far,
+		//so the tables of earlier volumes can map this one until its own are built
+		m_volume.widenRange(min, max);
+
+		if (m_volume.min() != min || m_volume.max() != max)
+		{
+			m_simpleMapper = SimpleEqualizer(&m_volume);
+
+			//Tables of a narrower range cannot map this volume, only then are they rebuilt before drawing
+			m_histogramMapper = HistogramEqualizer(&m_volume);
+			m_adaptiveMapper = AdaptiveEqualizer(&m_volume);
+		}
+
+		//Data derived from the voxels is rebuilt on first use
+		resetSubimageSources();
+
+		m_macrocells.reset();
+		m_summedVolume.reset();
+
+		//Statistics of the previous volume are kept until the next ones are requested and built
+		m_statisticsStale = true;
+		m_layoutVolume.reset();
+
+		//The isotropic copy of the previous volume no longer applies
+		m_isotropic = Volume();
+	}
+
+	//Equalization tables follow the histogram of every volume
+	buildEqualizers();
+
+	//Views are notified once the isotropic copy of the new volume is installed, so each frame is drawn once
+	if (m_isotropicEnabled && resampleIsotropic())
+	{
+		m_volumeChangePending = true;
+		return;
+	}
+
+	changed(InputVolume);
+}
+
+void VolumeRender::enableIsotropic(bool enable)
+{
+	if (enable == m_isotropicEnabled)
+		return;
+
+	m_isotropicEnabled = enable;
+
+	if (enable)
+	{
+		resampleIsotropic();
+		return;
+	}
+
+	m_isotropicBuild.cancel();
+
+	{
+		QWriteLocker lock(&m_volumeLock);
+		m_isotropic = Volume();
+
+		//Pyramids, replicas, macrocells and the layout copy may have been built from the isotropic copy
+		resetSubimageSources();
+		m_macrocells.reset();
+		m_layoutVolume.reset();
+	}
+
+	//A volume replaced while the cancelled copy was being built has not been announced yet
+	changed(takeVolumeChange() | InputResampling);
+}
+
+void VolumeRender::setResampleKernel(ResampleKernel kernel)
+{
+	if (kernel == m_resampleKernel)
+		return;
+
+	m_resampleKernel = kernel;
+
+	if (m_isotropicEnabled)
+	{
+		resampleIsotropic();
+	}
+}
+
+void VolumeRender::setReplicaBudget(quint64 bytes)
+{
+	if (bytes == m_replicaBudget)
+		return;
+
+	{
+		QWriteLocker lock(&m_volumeLock);
+
+		m_replicaBudget = bytes;
+		resetSubimageSources();
+	}
+
+	//Images are the same, only the speed of drawing them changes
+}
+
+void VolumeRender::setLayout3D(VolumeLayout layout)
+{
+	if (layout == m_layout3D)
+		return;
+
+	{
+		QWriteLocker lock(&m_volumeLock);
+
+		m_layout3D = layout;
+		m_layoutVolume.reset();
+	}
+
+	//Images are the same, only the speed of drawing them changes
+}
+
+bool VolumeRender::resampleIsotropic()
+{
+	//Nothing to do for volumes which are already isotropic
+	if (VolumeResampler::isIsotropic(m_volume))
+		return false;
+
+	//Voxels are shared with the copy, not duplicated
+	Volume source;
+
+	{
+		QReadLocker lock(&m_volumeLock);
+		source = m_volume;
+	}
+
+	const ResampleKernel kernel = m_resampleKernel;
+
+	m_isotropicBuild.setFuture(QtConcurrent::run([source, kernel]() {
+		return VolumeResampler::isotropic(source, kernel);
+	}));
+
+	return true;
+}
+
+void VolumeRender::installIsotropic()
+{
+	//Results of builds which were replaced by a newer one are discarded
+	if (!m_isotropicEnabled || m_isotropicBuild.isCanceled() || !m_isotropicBuild.isFinished())
+		return;
+
+	{
+		QWriteLocker lock(&m_volumeLock);
+		m_isotropic = m_isotropicBuild.result();
+
+		resetSubimageSources();
+		m_macrocells.reset();
+		m_layoutVolume.reset();
+	}
+
+	changed(takeVolumeChange() | InputResampling);
+}
+
+void VolumeRender::buildStatistics()
+{
+	//A volume replaced during a build is picked up by the next request
+	if (m_statisticsBuild.isRunning())
+		return;
+
+	m_statisticsStale = false;
+
+	//Voxels are shared with the copy, not duplicated
+	Volume source;
+
+	{
+		QReadLocker lock(&m_volumeLock);
+		source = m_volume;
+	}
+
+	RenderThreadPool* pool = &m_pool;
+
+	m_statisticsBuild.setFuture(QtConcurrent::run([source, pool]() {
+		return std::shared_ptr<const VolumeStatistics>(new VolumeStatistics(&source, pool, PriorityBackground));
+	}));
+}
+
+void VolumeRender::installStatistics()
+{
+	m_volumeStatistics = m_statisticsBuild.result();
+	emit statisticsReady();
+}
+
+void VolumeRender::buildEqualizers()
+{
+	if (m_equalizerBuild.isRunning())
+	{
+		m_equalizerPending = true;
+		return;
+	}
+
+	m_equalizerPending = false;
+
+	//Voxels are shared with the copy, not duplicated
+	Volume source;
+
+	{
+		QReadLocker lock(&m_volumeLock);
+		source = m_volume;
+	}
+
+	m_equalizerBuild.setFuture(QtConcurrent::run([source]() {
+		return std::make_shared<EqualizerTables>(&source);
+	}));
+}
+
+void VolumeRender::installEqualizers()
+{
+	const std::shared_ptr<EqualizerTables> tables = m_equalizerBuild.result();
+
+	bool installed = false;
+
+	{
+		QWriteLocker lock(&m_volumeLock);
+
+		//Tables built before the value range was widened cannot map the current volume
+		if (tables->min == m_volume.min() && tables->max == m_volume.max())
+		{
+			m_histogramMapper = tables->histogram;
+			m_histogramMapper.rebind(&m_volume);
+
+			m_adaptiveMapper = tables->adaptive;
+			m_adaptiveMapper.rebind(&m_volume);
+
+			installed = true;
+		}
+	}
+
+	if (m_equalizerPending)
+	{
+		buildEqualizers();
+	}
+
+	//Only the equalized mappings change
+	if (installed && (histEnabled() || m_adaptive))
+	{
+		changed(InputMapping);
+	}
+}
+
+quint32 VolumeRender::takeVolumeChange()
+{
+	const quint32 inputs = m_volumeChangePending ? (quint32)InputVolume : 0u;
+	m_volumeChangePending = false;
+	return inputs;
+}
+
 bool VolumeRender::histEnabled() const
 {
 	return m_mapper == &m_histogramMapper;
@@ -116,6 +819,9 @@ bool VolumeRender::histEnabled() const
 
 void VolumeRender::enableHist(bool enable)
 {
+	if (enable == histEnabled())
+		return;
+
 	//Change colour mapping table
 	if (enable)
 	{
@@ -128,7 +834,17 @@ void VolumeRender::enableHist(bool enable)
 		m_mapper = &m_simpleMapper;
 	}
 
-	emit redraw2D();
+	changed(InputMapping);
+}
+
+void VolumeRender::enableAdaptiveHist(bool enable)
+{
+	if (enable == m_adaptive)
+		return;
+
+	m_adaptive = enable;
+
+	changed(InputMapping);
 }
 
 SamplerType2D VolumeRender::getSamplingType() const
@@ -168,10 +884,13 @@ void VolumeRender::setSamplingType(SamplerType2D type)
 		&BicubicSampler::sample
 	};
 
+	if (m_samplerFunc == funcs[type])
+		return;
+
 	//Choose sampling function
 	m_samplerFunc = funcs[type];
 
-	redraw2D();
+	changed(InputSampler2D);
 }
 
 void VolumeRender::setSamplingType3D(SamplerType3D type)
@@ -182,9 +901,73 @@ void VolumeRender::setSamplingType3D(SamplerType3D type)
 		&TrilinearSampler::sample
 	};
 
+	if (m_samplerFunc3D == funcs[type])
+		return;
+
 	m_samplerFunc3D = funcs[type];
 
-	redraw3D();
+	changed(InputSampler3D);
+}
+
+void VolumeRender::setSampleFrequency(quint32 frequency)
+{
+	if (frequency == m_sampleFrequency)
+		return;
+
+	m_sampleFrequency = frequency;
+
+	changed(InputSampleFrequency);
+}
+
+ClipRegion VolumeRender::clipRegion() const
+{
+	QReadLocker lock(&m_volumeLock);
+	return m_clip;
+}
+
+void VolumeRender::setClipRegion(const ClipRegion& region)
+{
+	{
+		QWriteLocker lock(&m_volumeLock);
+
+		if (region == m_clip)
+			return;
+
+		m_clip = region;
+	}
+
+	changed(InputClip);
+}
+
+quint64 VolumeRender::maskCount() const
+{
+	QReadLocker lock(&m_volumeLock);
+	return m_mask.count();
+}
+
+void VolumeRender::setMask(const LabelMask& mask)
+{
+	{
+		QWriteLocker lock(&m_volumeLock);
+
+		if (mask == m_mask)
+			return;
+
+		m_mask = mask;
+	}
+
+	changed(InputMask);
+}
+
+void VolumeRender::changed(quint32 inputs)
+{
+	emit inputsChanged(inputs);
+
+	if (inputs & Inputs2D)
+		emit redraw2D();
+
+	if (inputs & Inputs3D)
+		emit redraw3D();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -8,14 +8,32 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QImage>
 #include <QPixmap>
 #include <QMatrix4x4>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QFutureWatcher>
 
 #include "Volume.h"
 #include "HistogramEqualization.h"
 #include "ImageBuffer.h"
 #include "Samplers.h"
+#include "VolumePyramid.h"
+#include "MacrocellGrid.h"
+#include "ObliqueSlice.h"
+#include "ClipRegion.h"
+#include "VolumeStatistics.h"
+#include "SummedVolumeTable.h"
+#include "RegionGrowing.h"
+#include "VolumeResampler.h"
+#include "VolumeReplica.h"
+#include "LayoutVolume.h"
+#include "RenderStatistics.h"
+#include "RenderThreadPool.h"
+#include "util/Lazy.h"
 
 enum SamplerType2D
 {
@@ -30,6 +48,45 @@ enum SamplerType3D
 	SamplingTrilinear,
 };
 
+/*
+	Render state inputs, as bit flags
+*/
+enum RenderInput
+{
+	InputMapping         = 1 << 0, //Colour mapping table
+	InputSampler2D       = 1 << 1,
+	InputSampler3D       = 1 << 2,
+	InputSampleFrequency = 1 << 3,
+	InputVolume          = 1 << 4, //Voxel data
+	InputClip            = 1 << 5, //Region of interest, used by projections
+	InputMask            = 1 << 6, //Segmented voxels, used by the 3D view
+	InputResampling      = 1 << 7, //Isotropic copy of the volume
+
+	//Inputs of each kind of drawing function
+	Inputs2D = InputMapping | InputSampler2D | InputVolume | InputResampling,
+	Inputs3D = InputSampler3D | InputSampleFrequency | InputVolume | InputClip | InputMask | InputResampling,
+	InputsOblique = InputMapping | InputSampler3D | InputVolume | InputResampling
+};
+
+/*
+	Quality of a draw call
+*/
+enum RenderQuality
+{
+	QualityFull,    //chosen sampling function
+	QualityPreview  //cheapest sampling function, for images redrawn while the user is dragging a control
+};
+
+enum RenderCall
+{
+	RenderSubimage,
+	RenderSubimageMIP,
+	Render3D,
+	RenderOblique,
+
+	RenderCallCount
+};
+
 /*
 	Volume rendering class
 */
@@ -40,34 +97,73 @@ class VolumeRender : public QObject
 
 	//Render state properties
 	Q_PROPERTY(bool hist READ histEnabled WRITE enableHist) // Histogram equalization
+	Q_PROPERTY(bool adaptiveHist READ adaptiveHistEnabled WRITE enableAdaptiveHist) // Adaptive histogram equalization
 	Q_PROPERTY(SamplerType2D sampling READ getSamplingType WRITE setSamplingType)
 	Q_PROPERTY(quint32 sampleFrequency READ getSampleFrequency WRITE setSampleFrequency)
 
 public:
 
+	//Default memory budget of slice replicas, room for both replicas of a 512x512x512 volume
+	static const quint64 ReplicaBudgetDefault = 512ull << 20;
+
 	/*
 		Construct a volume viewer
 	*/
 	explicit VolumeRender(Volume& volume, QObject* parent = nullptr);
 
+	/*
+		Waits for background work using the render threads to finish
+	*/
+	~VolumeRender();
+
 	//////////////////////////////////////////////////////////////////////////////////
 	// Drawing functions
 	//////////////////////////////////////////////////////////////////////////////////
 
 	/*
 		Draw a single subimage
+
+		Optionally only a region of the target is drawn, and previews use the cheapest sampling function
 	*/
-	void drawSubimage(ImageBuffer& target, Volume::IndexType index, VolumeAxis axis);
+	RenderStats drawSubimage(ImageBuffer& target, Volume::IndexType index, VolumeAxis axis, RenderPriority priority = PriorityInteractive, const QRect& region = QRect(), RenderQuality quality = QualityFull);
 
 	/*
 		Draw an axis of the volume using Maximum Intensity Projection
+
+		Only the slices inside the clip region are projected.
+		Optionally only a region of the target is drawn, and previews use the cheapest sampling function
+	*/
+	RenderStats drawSubimageMIP(ImageBuffer& target, VolumeAxis axis, RenderPriority priority = PriorityInteractive, const QRect& region = QRect(), RenderQuality quality = QualityFull);
+
+	/*
+		Draw an oblique slice through the volume, using the 3D sampling function
+
+		Optionally only a region of the target is drawn
 	*/
-	void drawSubimageMIP(ImageBuffer& target, VolumeAxis axis);
+	RenderStats drawOblique(ImageBuffer& target, const ObliqueSlice& slice, RenderPriority priority = PriorityInteractive, const QRect& region = QRect());
 
 	/*
 		Draw the volume in 3D applying the given transform
+
+		Rays are only cast through the clip region
 	*/
-	void draw3D(ImageBuffer& target, const QMatrix4x4& modelView);
+	RenderStats draw3D(ImageBuffer& target, const QMatrix4x4& modelView, RenderPriority priority = PriorityView);
+
+	//////////////////////////////////////////////////////////////////////////////////
+	// Segmentation
+	//////////////////////////////////////////////////////////////////////////////////
+
+	/*
+		Segment the volume by growing a region from a seed voxel, the region replaces the mask.
+
+		Voxels added to the region are counted as pixels and neighbours tested as samples.
+	*/
+	RenderStats growRegion(Volume::IndexType x, Volume::IndexType y, Volume::IndexType z, const RegionGrowing::Options& options, RenderPriority priority = PriorityInteractive);
+
+	/*
+		Rolling statistics of recent calls to a drawing function
+	*/
+	RenderStatistics statistics(RenderCall call) const;
 
 	//////////////////////////////////////////////////////////////////////////////////
 
@@ -76,12 +172,36 @@ public:
 	*/
 	const Volume* volume() const { return &m_volume; }
 
+	/*
+		Per-slice statistics of the volume, cached until the volume is replaced.
+
+		Requesting them after the volume changed starts a build in the background on the render threads
+		at background priority, and statisticsReady is emitted when it finishes. Until then the statistics
+		of the previous volume are returned, or null before the first build.
+	*/
+	std::shared_ptr<const VolumeStatistics> volumeStatistics();
+
+	/*
+		Summed volume table of the volume, for totals of boxes of voxels in constant time.
+
+		Built on first use and kept until the volume is replaced.
+	*/
+	const SummedVolumeTable& summedVolume();
+
+	/*
+		Threads draw calls are run on
+	*/
+	RenderThreadPool* threadPool() { return &m_pool; }
+
 	/*
 		Properties
 	*/
 
 	//Returns true if colour mapping table is set to Histogram Equalization
 	bool histEnabled() const;
+
+	//Returns true if colour mapping is set to Contrast Limited Adaptive Histogram Equalization
+	bool adaptiveHistEnabled() const { return m_adaptive; }
 	
 	//Return the sampling type
 	SamplerType2D getSamplingType() const;
@@ -90,11 +210,40 @@ public:
 	//Return the raycast sample frequency
 	quint32 getSampleFrequency() const { return m_sampleFrequency; }
 
+	//Return the region of interest of projections
+	ClipRegion clipRegion() const;
+
+	//Return the number of voxels in the segmentation mask
+	quint64 maskCount() const;
+
+	//Return the memory X and Y slice replicas may use in bytes
+	quint64 replicaBudget() const { return m_replicaBudget; }
+
+	//Return whether an isotropic copy of the volume is sampled, and the kernel it is resampled with
+	bool isotropicEnabled() const { return m_isotropicEnabled; }
+	ResampleKernel resampleKernel() const { return m_resampleKernel; }
+
+	//Return the voxel layout the 3D view samples
+	VolumeLayout layout3D() const { return m_layout3D; }
+
 public slots:
 
+	/*
+		Replace the voxel data, for example with the next frame of a time series.
+
+		The volume must have the same dimensions as the current one, the voxel data is shared, not copied.
+		Waits for draw calls in progress on other threads to finish.
+		With isotropic resampling enabled, InputVolume is emitted once the isotropic copy of the new volume is installed.
+	*/
+	void setVolume(const Volume& volume);
+
 	//Set the colour mapping table to Histogram Equalization
 	void enableHist(bool enable);
 
+	//Set the colour mapping to Contrast Limited Adaptive Histogram Equalization
+	//Takes precedence over the global colour mapping table
+	void enableAdaptiveHist(bool enable);
+
 	//Set the sampling type
 	void setSamplingType(SamplerType2D type);
 	void setSamplingType3D(SamplerType3D type);
@@ -108,29 +257,175 @@ public slots:
 	void setSamplingTypeTrilinear() { setSamplingType3D(SamplingTrilinear); }
 
 	//Set the raycast sampling frequency
-	void setSampleFrequency(quint32 frequency) { m_sampleFrequency = frequency; redraw3D(); }
+	void setSampleFrequency(quint32 frequency);
+
+	//Set the region of interest of projections, waits for draw calls in progress on other threads
+	void setClipRegion(const ClipRegion& region);
+
+	//Set the mask of voxels shown by the 3D view, an empty mask shows every voxel
+	//Kept when the volume is replaced by another frame, waits for draw calls in progress on other threads
+	void setMask(const LabelMask& mask);
+	void clearMask() { setMask(LabelMask()); }
+
+	//Sample an isotropic copy of an anisotropic volume, resampled once in the background.
+	//Views sample the original volume until the copy is ready, and the copy is rebuilt when the volume is replaced.
+	//The 2D views only use it for axes with a scale of one, where slice indices are the same in both volumes.
+	void enableIsotropic(bool enable);
+	void setResampleKernel(ResampleKernel kernel);
+
+	//Set the memory X and Y slice replicas may use in bytes, 0 draws every axis from the volume itself
+	void setReplicaBudget(quint64 bytes);
+
+	//Set the voxel layout the 3D view samples, copies in bricked or Morton order are built on first use.
+	//Images are the same in every layout, only the memory locality of rays changes.
+	void setLayout3D(VolumeLayout layout);
 
 signals:
 
+	//Emitted when render state changes, with the RenderInput flags which changed
+	void inputsChanged(quint32 inputs);
+
+	//Emitted when render state used by the 2D/3D drawing functions changes
 	void redraw2D();
 	void redraw3D();
 
+	//Emitted when the statistics of the volume finish building
+	void statisticsReady();
+
 private:
 
+	//Notify of changed inputs
+	void changed(quint32 inputs);
+
+	/*
+		Volume and axis to draw the subimages of an axis from
+	*/
+	struct SubimageSource
+	{
+		const Volume* volume;
+		VolumeAxis axis;  //Z for a replica
+	};
+
+	//Choose the volume to draw subimages of an axis from, for a given output size
+	SubimageSource subimageSource(VolumeAxis axis, const ImageBuffer& target, RenderCounters& counters);
+
+	//True if a replica of a volume for an axis fits in the memory budget, X has the first claim
+	bool replicaFits(VolumeAxis axis, const Volume& volume) const;
+
+	//Discard data built from the volume the subimages are drawn from, with the volume lock held for writing
+	void resetSubimageSources();
+
+	//Sampling function of subimages drawn at a given quality
+	SamplerFunc2D subimageSampler(RenderQuality quality) const;
+
+	//Volume sampled by the 3D and oblique views, the isotropic copy once it is ready
+	const Volume& sampledVolume() const { return (m_isotropic.sizeX() > 0) ? m_isotropic : m_volume; }
+
+	//Start resampling the current volume in the background, and install the result when it finishes
+	//Returns false if the volume is already isotropic and nothing is resampled
+	bool resampleIsotropic();
+	void installIsotropic();
+
+	//InputVolume if a replaced volume has not been announced yet, as it waits for its isotropic copy, otherwise 0
+	quint32 takeVolumeChange();
+
+	/*
+		Equalization tables of a volume, built in the background
+	*/
+	struct EqualizerTables
+	{
+		explicit EqualizerTables(const Volume* volume) :
+			histogram(volume),
+			adaptive(volume),
+			min(volume->min()),
+			max(volume->max())
+		{}
+
+		HistogramEqualizer histogram;
+		AdaptiveEqualizer adaptive;
+
+		//Value range the tables map
+		Volume::ElementType min;
+		Volume::ElementType max;
+	};
+
+	//Start building the statistics of the current volume in the background, and install them when they finish
+	void buildStatistics();
+	void installStatistics();
+
+	//Start building the equalization tables of the current volume in the background, and install them when they finish
+	//A volume replaced during a build is coalesced into one more build
+	void buildEqualizers();
+	void installEqualizers();
+
+	//Record statistics of a draw call
+	RenderStats record(RenderCall call, const RenderCounters& counters, qint64 wallTimeNs);
+
 	//Volume data
 	Volume m_volume;
+	//Held for reading by draw calls and for writing while the volume or clip region is replaced
+	mutable QReadWriteLock m_volumeLock;
+
+	//Downsampled subimages of each axis, built on first use
+	Lazy<VolumePyramid> m_pyramids[3];
+
+	//Transposed copies with contiguous X and Y slices, built on first use within the budget
+	Lazy<Volume> m_replicas[2];
+	quint64 m_replicaBudget = ReplicaBudgetDefault;
+
+	//Copy of the sampled volume in the 3D view's layout, built on first use unless the layout is linear
+	Lazy<LayoutVolume> m_layoutVolume;
+	VolumeLayout m_layout3D = LayoutLinear;
+
+	//Block maxima used to skip empty space when raycasting, built on first use
+	Lazy<MacrocellGrid> m_macrocells;
+
+	//Per-slice statistics, built in the background on request
+	std::shared_ptr<const VolumeStatistics> m_volumeStatistics;
+	QFutureWatcher<std::shared_ptr<const VolumeStatistics>> m_statisticsBuild;
+	bool m_statisticsStale = true;
+
+	//Summed volume table for region of interest measurements, built on first use
+	Lazy<SummedVolumeTable> m_summedVolume;
 
 	//Sampling function
-	SamplerFunc2D m_samplerFunc;
-	SamplerFunc3D m_samplerFunc3D;
+	SamplerFunc2D m_samplerFunc = nullptr;
+	SamplerFunc3D m_samplerFunc3D = nullptr;
 
 	//Raycast sample frequency
 	quint32 m_sampleFrequency;
 
+	//Region of interest, guarded by the volume lock
+	ClipRegion m_clip;
+
+	//Segmented voxels, guarded by the volume lock
+	LabelMask m_mask;
+
+	//Isotropic copy of the volume, empty until resampled, guarded by the volume lock
+	bool m_isotropicEnabled = false;
+	ResampleKernel m_resampleKernel = ResampleLinear;
+	Volume m_isotropic;
+	QFutureWatcher<Volume> m_isotropicBuild;
+	bool m_volumeChangePending = false;
+
+	//Equalization tables of a replaced volume, the previous tables map it until they are ready
+	QFutureWatcher<std::shared_ptr<EqualizerTables>> m_equalizerBuild;
+	bool m_equalizerPending = false;
+
 	//Colour mapping tables
 	HistogramEqualizer m_histogramMapper;
 	SimpleEqualizer m_simpleMapper;
+	AdaptiveEqualizer m_adaptiveMapper;
 
 	//Current colour mapping table
 	const MappingTable* m_mapper;
+	//Use adaptive colour mapping
+	bool m_adaptive = false;
+
+	//Draw call threads
+	RenderThreadPool m_pool;
+
+	//Draw call statistics
+	mutable QMutex m_statsMutex;
+	RenderStatistics m_statistics[RenderCallCount];
 };
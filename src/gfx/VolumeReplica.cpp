@@ -0,0 +1,85 @@
+/*
+	Volume replica source
+*/
+
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+#include "VolumeReplica.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+enum Constants
+{
+	//Side of the square tiles an X replica is transposed in, a tile of source and destination rows fits in L1 cache
+	TILE_SIZE = 32
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Volume VolumeReplica::transpose(const Volume& volume, VolumeAxis axis)
+{
+	TRACE_SCOPE_ARG("transposeVolume", axis);
+
+	Q_ASSERT(axis != ZAxis);
+
+	const Volume::SizeType sizeX = volume.sizeX();
+	const Volume::SizeType sizeY = volume.sizeY();
+	const Volume::SizeType sizeZ = volume.sizeZ();
+
+	QVector<Volume::ElementType> data((int)((size_t)sizeX * sizeY * sizeZ));
+	Volume::ElementType* const out = data.data();
+
+	Volume::Dimensions dim;
+
+	if (axis == XAxis)
+	{
+		dim = Volume::Dimensions(sizeY, sizeZ, sizeX, volume.scaleY(), volume.scaleZ(), volume.scaleX());
+
+		//Each source slice fills one row of every replica slice, transposed a tile at a time
+		//so reads along x and writes along y both use whole cache lines
+		QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(sizeZ), [&](size_t z) {
+
+			const Volume::ElementType* src = volume.data() + volume.index(0, 0, (Volume::IndexType)z);
+
+			for (Volume::IndexType y0 = 0; y0 < sizeY; y0 += TILE_SIZE)
+			{
+				const Volume::IndexType y1 = std::min<Volume::IndexType>(y0 + TILE_SIZE, sizeY);
+
+				for (Volume::IndexType x0 = 0; x0 < sizeX; x0 += TILE_SIZE)
+				{
+					const Volume::IndexType x1 = std::min<Volume::IndexType>(x0 + TILE_SIZE, sizeX);
+
+					for (Volume::IndexType x = x0; x < x1; x++)
+					{
+						Volume::ElementType* dst = out + (size_t)sizeY * (z + (size_t)sizeZ * x);
+
+						for (Volume::IndexType y = y0; y < y1; y++)
+						{
+							dst[y] = src[(size_t)y * sizeX + x];
+						}
+					}
+				}
+			}
+		});
+	}
+	else
+	{
+		dim = Volume::Dimensions(sizeX, sizeZ, sizeY, volume.scaleX(), volume.scaleZ(), volume.scaleY());
+
+		//Rows along x stay contiguous, only their order changes
+		QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(sizeZ), [&](size_t z) {
+
+			for (Volume::IndexType y = 0; y < sizeY; y++)
+			{
+				const Volume::ElementType* src = volume.data() + volume.index(0, y, (Volume::IndexType)z);
+				std::copy(src, src + sizeX, out + (size_t)sizeX * (z + (size_t)sizeZ * y));
+			}
+		});
+	}
+
+	return Volume(dim, std::move(data));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
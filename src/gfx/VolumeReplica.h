@@ -0,0 +1,35 @@
+/*
+	Volume replicas
+
+	Z slices are contiguous in a volume, but the slices of X and Y stride across the whole buffer.
+	A replica is a transposed copy of a volume whose Z slices are the slices of another axis,
+	so they can be drawn with the same contiguous access as Z slices:
+
+	Axis	Replica size		Replica Z slice
+	X		sizeY, sizeZ, sizeX	u = y, v = z
+	Y		sizeX, sizeZ, sizeY	u = x, v = z
+
+	The u and v axes match those of VolumeSubimage, so a subimage of the replica along Z is the subimage of the volume.
+*/
+
+#pragma once
+
+#include "Volume.h"
+
+class VolumeReplica
+{
+public:
+
+	/*
+		Build the replica of a volume for the slices of the X or Y axis
+	*/
+	static Volume transpose(const Volume& volume, VolumeAxis axis);
+
+	/*
+		Memory used by a replica of a volume in bytes
+	*/
+	static quint64 bytes(const Volume& volume)
+	{
+		return (quint64)volume.sizeX() * volume.sizeY() * volume.sizeZ() * sizeof(Volume::ElementType);
+	}
+};
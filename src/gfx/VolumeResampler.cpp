@@ -0,0 +1,217 @@
+/*
+	Volume resampler source
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+#include "VolumeResampler.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+enum Constants
+{
+	//Source voxels weighted by the widest kernel
+	TAPS_MAX = 4
+};
+
+/*
+	Source voxels and weights of one output voxel along the resampled axis
+*/
+struct ResampleTaps
+{
+	Volume::IndexType index[TAPS_MAX];
+	float weight[TAPS_MAX];
+	int count = 0;
+};
+
+/*
+	Taps of every output voxel of an axis of a given size upsampled by a given factor
+*/
+static std::vector<ResampleTaps> resampleTaps(Volume::SizeType size, Volume::SizeType factor, ResampleKernel kernel)
+{
+	std::vector<ResampleTaps> taps(size * factor);
+
+	auto clamp = [size](qint64 i) {
+		return (Volume::IndexType)std::min(std::max(i, (qint64)0), (qint64)size - 1);
+	};
+
+	for (size_t j = 0; j < taps.size(); j++)
+	{
+		ResampleTaps& t = taps[j];
+
+		//Position of the output voxel centre in source voxel coordinates
+		const float pos = (((float)j + 0.5f) / factor) - 0.5f;
+		const float base = std::floor(pos);
+		const float f = pos - base;
+		const qint64 i = (qint64)base;
+
+		switch (kernel)
+		{
+		case ResampleNearest:
+			t.count = 1;
+			t.index[0] = clamp((qint64)std::floor(pos + 0.5f));
+			t.weight[0] = 1.0f;
+			break;
+
+		case ResampleLinear:
+			t.count = 2;
+			t.index[0] = clamp(i);
+			t.index[1] = clamp(i + 1);
+			t.weight[0] = 1.0f - f;
+			t.weight[1] = f;
+			break;
+
+		default:
+		{
+			//Catmull-Rom weights
+			const float f2 = f * f;
+			const float f3 = f2 * f;
+
+			t.count = 4;
+			t.weight[0] = 0.5f * (-f3 + 2.0f * f2 - f);
+			t.weight[1] = 0.5f * (3.0f * f3 - 5.0f * f2 + 2.0f);
+			t.weight[2] = 0.5f * (-3.0f * f3 + 4.0f * f2 + f);
+			t.weight[3] = 0.5f * (f3 - f2);
+
+			for (int k = 0; k < 4; k++)
+			{
+				t.index[k] = clamp(i - 1 + k);
+			}
+			break;
+		}
+		}
+	}
+
+	return taps;
+}
+
+/*
+	Upsample a volume along one axis.
+
+	Output slices are filled in parallel. Along Y and Z an output row is a weighted sum of whole source rows,
+	so the inner loop is a contiguous multiply-add; along X the taps of each voxel are gathered from one source row.
+*/
+static Volume resampleAxis(const Volume& volume, VolumeAxis axis, ResampleKernel kernel)
+{
+	TRACE_SCOPE_ARG("resampleAxis", axis);
+
+	const Volume::SizeType factor = volume.axisScale(axis);
+	const std::vector<ResampleTaps> taps = resampleTaps(volume.axisSize(axis), factor, kernel);
+
+	Volume::Dimensions dim = volume.dimensions();
+
+	switch (axis)
+	{
+	case XAxis: dim.sizeX *= factor; dim.scaleX = 1; break;
+	case YAxis: dim.sizeY *= factor; dim.scaleY = 1; break;
+	case ZAxis: dim.sizeZ *= factor; dim.scaleZ = 1; break;
+	}
+
+	const float lowest = volume.min();
+	const float highest = volume.max();
+
+	QVector<Volume::ElementType> data((int)((size_t)dim.sizeX * dim.sizeY * dim.sizeZ));
+	Volume::ElementType* const out = data.data();
+
+	QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(dim.sizeZ), [&](size_t z) {
+
+		std::vector<float> sum(dim.sizeX);
+
+		for (Volume::IndexType y = 0; y < dim.sizeY; y++)
+		{
+			Volume::ElementType* dst = out + (size_t)dim.sizeX * (y + (size_t)dim.sizeY * z);
+
+			if (axis == XAxis)
+			{
+				const Volume::ElementType* src = volume.data() + volume.index(0, y, (Volume::IndexType)z);
+
+				for (Volume::IndexType x = 0; x < dim.sizeX; x++)
+				{
+					const ResampleTaps& t = taps[x];
+					float value = 0.0f;
+
+					for (int k = 0; k < t.count; k++)
+					{
+						value += t.weight[k] * src[t.index[k]];
+					}
+
+					sum[x] = value;
+				}
+			}
+			else
+			{
+				const ResampleTaps& t = (axis == YAxis) ? taps[y] : taps[z];
+
+				std::fill(sum.begin(), sum.end(), 0.0f);
+
+				for (int k = 0; k < t.count; k++)
+				{
+					const Volume::ElementType* src = (axis == YAxis)
+						? volume.data() + volume.index(0, t.index[k], (Volume::IndexType)z)
+						: volume.data() + volume.index(0, y, t.index[k]);
+
+					const float w = t.weight[k];
+
+					for (Volume::IndexType x = 0; x < dim.sizeX; x++)
+					{
+						sum[x] += w * src[x];
+					}
+				}
+			}
+
+			//Cubic weights can overshoot the range of the original
+			for (Volume::IndexType x = 0; x < dim.sizeX; x++)
+			{
+				dst[x] = (Volume::ElementType)std::lround(std::min(std::max(sum[x], lowest), highest));
+			}
+		}
+	});
+
+	return Volume(dim, std::move(data));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VolumeResampler::isIsotropic(const Volume& volume)
+{
+	return volume.scaleX() == 1 && volume.scaleY() == 1 && volume.scaleZ() == 1;
+}
+
+Volume VolumeResampler::isotropic(const Volume& volume, ResampleKernel kernel)
+{
+	TRACE_SCOPE("resampleIsotropic");
+
+	Volume result = volume;
+
+	for (VolumeAxis axis : { XAxis, YAxis, ZAxis })
+	{
+		if (result.axisScale(axis) > 1)
+		{
+			result = resampleAxis(result, axis, kernel);
+		}
+	}
+
+	return result;
+}
+
+QStringList VolumeResampler::kernelNames()
+{
+	return { QStringLiteral("nearest"), QStringLiteral("linear"), QStringLiteral("cubic") };
+}
+
+bool VolumeResampler::parseKernel(const QString& name, ResampleKernel& kernel)
+{
+	const int index = kernelNames().indexOf(name.trimmed().toLower());
+
+	if (index < 0)
+		return false;
+
+	kernel = (ResampleKernel)index;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,48 @@
+/*
+	Volume resampler
+
+	Resamples an anisotropic volume, such as one with slices twice as thick as its pixels are wide,
+	to isotropic spacing: every axis with a scale factor greater than one gets that many times as many voxels.
+
+	Voxel centres of the result are spread evenly over the same extent as the original,
+	so normalized volume coordinates refer to the same point in both volumes.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "Volume.h"
+
+enum ResampleKernel
+{
+	ResampleNearest,
+	ResampleLinear,
+	ResampleCubic  //Catmull-Rom, results are clamped to the value range of the original
+};
+
+class VolumeResampler
+{
+public:
+
+	/*
+		True if every axis of a volume has a scale factor of one
+	*/
+	static bool isIsotropic(const Volume& volume);
+
+	/*
+		Resample a volume to isotropic spacing, one pass along each anisotropic axis with output slices in parallel
+	*/
+	static Volume isotropic(const Volume& volume, ResampleKernel kernel);
+
+	/*
+		Names of kernels, indexed by kernel
+	*/
+	static QStringList kernelNames();
+
+	/*
+		Parse a kernel from its name, returns false if the name is unknown
+	*/
+	static bool parseKernel(const QString& name, ResampleKernel& kernel);
+};
@@ -0,0 +1,277 @@
+/*
+	Volume time series source
+*/
+
+#include <QSettings>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QtConcurrentRun>
+
+#include "VolumeSeries.h"
+#include "VolumeLoader.h"
+#include "util/Trace.h"
+
+enum Constants
+{
+	//Frames are read concurrently with decoding, more threads only compete for the disk
+	LOADER_THREADS = 2
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QString VolumeSeries::Statistics::toString() const
+{
+	return QString("%1 frames read, %2 stalls, %3 MB/s")
+		.arg(loaded)
+		.arg(stalls)
+		.arg(bandwidth(), 0, 'f', 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VolumeSeries::VolumeSeries()
+{
+	m_loaders.setMaxThreadCount(LOADER_THREADS);
+}
+
+VolumeSeries::~VolumeSeries()
+{
+	m_loaders.clear();
+	m_loaders.waitForDone();
+}
+
+bool VolumeSeries::open(const QString& configPath, QString* error)
+{
+	if (!VolumeLoader::readConfig(configPath, m_dimensions, m_dataset, error))
+		return false;
+
+	QSettings config(configPath, QSettings::IniFormat);
+
+	m_frameCount = std::max(config.value("Application/timePoints", 1).toInt(), 1);
+	m_filePerFrame = m_dataset.contains(QStringLiteral("%1"));
+
+	const qint64 frameBytes = (qint64)m_dimensions.sizeX * m_dimensions.sizeY * m_dimensions.sizeZ * sizeof(Volume::ElementType);
+
+	//Frames stored back to back must all be present
+	if (!m_filePerFrame)
+	{
+		QFile file(m_dataset);
+
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			if (error != nullptr)
+				*error = file.errorString();
+
+			return false;
+		}
+
+		if (file.size() < frameBytes * m_frameCount)
+		{
+			if (error != nullptr)
+				*error = QStringLiteral("Dataset is smaller than the configured dimensions and time points: ") + m_dataset;
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int VolumeSeries::window() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_window;
+}
+
+void VolumeSeries::setWindow(int frames)
+{
+	QMutexLocker lock(&m_mutex);
+	m_window = std::max(frames, 1);
+	evict();
+}
+
+bool VolumeSeries::frame(int index, Volume& volume, QString* error)
+{
+	Q_ASSERT(index >= 0 && index < m_frameCount);
+
+	QMutexLocker lock(&m_mutex);
+
+	//Wait for a loader already reading the frame
+	bool stalled = false;
+
+	while (m_loading.contains(index) && !m_frames.contains(index))
+	{
+		stalled = true;
+		m_frameLoaded.wait(&m_mutex);
+	}
+
+	auto it = m_frames.constFind(index);
+
+	if (it != m_frames.constEnd())
+	{
+		if (stalled)
+			m_stats.stalls++;
+
+		volume = *it;
+		return true;
+	}
+
+	//Not in memory, read it now
+	m_stats.stalls++;
+	m_loading.insert(index);
+
+	lock.unlock();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	Volume loaded;
+	const bool ok = read(index, loaded, error);
+
+	lock.relock();
+
+	m_loading.remove(index);
+	m_frameLoaded.wakeAll();
+
+	if (!ok)
+		return false;
+
+	m_stats.loaded++;
+	m_stats.bytes += (quint64)loaded.sizeX() * loaded.sizeY() * loaded.sizeZ() * sizeof(Volume::ElementType);
+	m_stats.readNs += timer.nsecsElapsed();
+
+	m_frames.insert(index, loaded);
+	volume = loaded;
+
+	return true;
+}
+
+void VolumeSeries::prefetch(int cursor, int direction)
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_cursor = ((cursor % m_frameCount) + m_frameCount) % m_frameCount;
+	m_direction = (direction < 0) ? -1 : 1;
+
+	evict();
+
+	//Queue missing frames of the window, nearest first
+	const int frames = std::min(m_window, m_frameCount);
+
+	for (int i = 0; i < frames; i++)
+	{
+		const int index = (((m_cursor + m_direction * i) % m_frameCount) + m_frameCount) % m_frameCount;
+
+		if (m_frames.contains(index) || m_loading.contains(index))
+			continue;
+
+		m_loading.insert(index);
+
+		QtConcurrent::run(&m_loaders, [this, index]() {
+			load(index);
+		});
+	}
+}
+
+VolumeSeries::Statistics VolumeSeries::statistics() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_stats;
+}
+
+void VolumeSeries::resetStatistics()
+{
+	QMutexLocker lock(&m_mutex);
+	m_stats = Statistics();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VolumeSeries::read(int index, Volume& volume, QString* error) const
+{
+	TRACE_SCOPE_ARG("loadFrame", index);
+
+	const qint64 frameBytes = (qint64)m_dimensions.sizeX * m_dimensions.sizeY * m_dimensions.sizeZ * sizeof(Volume::ElementType);
+
+	QFile file(m_filePerFrame ? m_dataset.arg(index) : m_dataset);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		if (error != nullptr)
+			*error = file.errorString();
+
+		return false;
+	}
+
+	const qint64 offset = m_filePerFrame ? 0 : frameBytes * index;
+
+	if (file.size() < offset + frameBytes || !file.seek(offset))
+	{
+		if (error != nullptr)
+			*error = QStringLiteral("Frame %1 is missing from the dataset: %2").arg(index).arg(file.fileName());
+
+		return false;
+	}
+
+	volume = Volume(file, m_dimensions);
+
+	return true;
+}
+
+void VolumeSeries::load(int index)
+{
+	{
+		QMutexLocker lock(&m_mutex);
+
+		//Playback moved on before the frame was started
+		if (!wanted(index))
+		{
+			m_loading.remove(index);
+			m_frameLoaded.wakeAll();
+			return;
+		}
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	Volume loaded;
+	const bool ok = read(index, loaded, nullptr);
+
+	QMutexLocker lock(&m_mutex);
+
+	m_loading.remove(index);
+
+	if (ok)
+	{
+		m_stats.loaded++;
+		m_stats.bytes += (quint64)loaded.sizeX() * loaded.sizeY() * loaded.sizeZ() * sizeof(Volume::ElementType);
+		m_stats.readNs += timer.nsecsElapsed();
+
+		if (wanted(index))
+			m_frames.insert(index, loaded);
+	}
+
+	m_frameLoaded.wakeAll();
+}
+
+bool VolumeSeries::wanted(int index) const
+{
+	//Distance ahead of the cursor in the direction of playback
+	const int distance = ((((index - m_cursor) * m_direction) % m_frameCount) + m_frameCount) % m_frameCount;
+
+	return distance < m_window;
+}
+
+void VolumeSeries::evict()
+{
+	for (auto it = m_frames.begin(); it != m_frames.end();)
+	{
+		if (wanted(it.key()))
+			++it;
+		else
+			it = m_frames.erase(it);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,137 @@
+/*
+	Volume time series
+
+	A sequence of volumes with the same dimensions sampled over time, such as a perfusion or cardiac series,
+	streamed from disk one frame at a time.
+
+	Frames are described by the same config file as a single volume, with the number of frames given by timePoints.
+	They are stored back to back in the dataset file, or in one file per frame if the dataset path contains %1,
+	which is replaced by the frame number:
+
+	[Application]
+	dataset="perfusion/frame%1.raw"
+	timePoints=40
+
+	Only a window of decoded frames ahead of the playback cursor is kept in memory. Frames entering the window
+	are read on loader threads, nearest first, so playback only waits for the disk when it overtakes the loaders.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+
+#include "Volume.h"
+
+class VolumeSeries
+{
+	Q_DISABLE_COPY(VolumeSeries)
+
+public:
+
+	/*
+		Loading counters
+	*/
+	struct Statistics
+	{
+		quint64 loaded = 0;  //frames read from disk
+		quint64 stalls = 0;  //frames requested before they were read
+		quint64 bytes = 0;   //bytes read
+		qint64 readNs = 0;   //time spent reading, summed over loader threads
+
+		//Read throughput in megabytes per second
+		double bandwidth() const { return (readNs > 0) ? ((double)bytes * 1000.0 / readNs) : 0.0; }
+
+		QString toString() const;
+	};
+
+	VolumeSeries();
+
+	/*
+		Abandons queued frames and waits for frames being read
+	*/
+	~VolumeSeries();
+
+	/*
+		Open the series described by a config file
+	*/
+	bool open(const QString& configPath, QString* error = nullptr);
+
+	/*
+		Number of frames
+	*/
+	int frameCount() const { return m_frameCount; }
+
+	/*
+		Dimensions shared by every frame
+	*/
+	const Volume::Dimensions& dimensions() const { return m_dimensions; }
+
+	/*
+		Number of frames kept in memory, starting at the playback cursor
+	*/
+	int window() const;
+	void setWindow(int frames);
+
+	/*
+		Fetch a frame.
+
+		The voxel data is shared with the window, not copied.
+		Frames which are not in memory yet are read on the calling thread.
+	*/
+	bool frame(int index, Volume& volume, QString* error = nullptr);
+
+	/*
+		Move the playback cursor.
+
+		Frames outside the window are released and the frames in it which are not in memory are queued for loading.
+		Direction is the sign of playback, the window wraps around at either end of the series.
+	*/
+	void prefetch(int cursor, int direction = 1);
+
+	/*
+		Loading counters since the series was opened or the counters were last reset
+	*/
+	Statistics statistics() const;
+	void resetStatistics();
+
+private:
+
+	//Read a frame from disk
+	bool read(int index, Volume& volume, QString* error) const;
+
+	//Loader thread task
+	void load(int index);
+
+	//True if a frame is inside the window, must be called with the mutex held
+	bool wanted(int index) const;
+
+	//Release frames outside the window, must be called with the mutex held
+	void evict();
+
+	//Series layout
+	Volume::Dimensions m_dimensions;
+	QString m_dataset;
+	bool m_filePerFrame = false;
+	int m_frameCount = 0;
+
+	mutable QMutex m_mutex;
+	QWaitCondition m_frameLoaded;
+
+	//Playback window
+	int m_window = 8;
+	int m_cursor = 0;
+	int m_direction = 1;
+
+	//Decoded frames, and frames being read
+	QHash<int, Volume> m_frames;
+	QSet<int> m_loading;
+
+	Statistics m_stats;
+
+	QThreadPool m_loaders;
+};
@@ -0,0 +1,236 @@
+/*
+	Volume statistics source
+*/
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "VolumeStatistics.h"
+#include "util/CountingIterator.h"
+#include "util/Trace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double VolumeStatistics::Summary::variance() const
+{
+	if (count == 0)
+		return 0.0;
+
+	const double m = mean();
+	return std::max(((double)sumSquares / count) - (m * m), 0.0);
+}
+
+double VolumeStatistics::Summary::stddev() const
+{
+	return std::sqrt(variance());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Running totals of a set of slices, stored as one array per quantity so the
+	per-voxel updates of consecutive slices are independent and vectorize
+*/
+struct SliceTotals
+{
+	QVector<qint64> sum;
+	QVector<quint64> squares;
+	QVector<Volume::ElementType> min;
+	QVector<Volume::ElementType> max;
+	QVector<quint32> histogram;
+
+	explicit SliceTotals(Volume::SizeType slices = 0) :
+		sum((int)slices, 0),
+		squares((int)slices, 0),
+		min((int)slices, std::numeric_limits<Volume::ElementType>::max()),
+		max((int)slices, std::numeric_limits<Volume::ElementType>::min()),
+		histogram((int)slices * VolumeStatistics::Bins, 0)
+	{}
+
+	//Add the totals of another set of the same slices
+	void merge(const SliceTotals& other)
+	{
+		for (int i = 0; i < sum.size(); i++)
+		{
+			sum[i] += other.sum[i];
+			squares[i] += other.squares[i];
+			min[i] = std::min(min[i], other.min[i]);
+			max[i] = std::max(max[i], other.max[i]);
+		}
+
+		for (int i = 0; i < histogram.size(); i++)
+		{
+			histogram[i] += other.histogram[i];
+		}
+	}
+};
+
+VolumeStatistics::VolumeStatistics(const Volume* volume, RenderThreadPool* pool, RenderPriority priority)
+{
+	TRACE_SCOPE("buildStatistics");
+
+	Q_ASSERT(volume != nullptr);
+
+	const Volume::SizeType sizeX = volume->sizeX();
+	const Volume::SizeType sizeY = volume->sizeY();
+	const Volume::SizeType sizeZ = volume->sizeZ();
+
+	//Fixed point scale from value to bin, the largest value maps to the last bin
+	const qint32 levels = (qint32)volume->max() - volume->min() + 1;
+
+	m_min = volume->min();
+	m_binScale = (qint32)(((qint64)Bins << 16) / levels);
+
+	const Volume::ElementType minValue = m_min;
+	const qint32 binScale = m_binScale;
+
+	//Z slices are contiguous so each belongs to one chunk,
+	//every chunk has its own totals of the X and Y slices which are merged afterwards
+	const Volume::SizeType threads = (pool != nullptr) ? (Volume::SizeType)pool->workerCount() + 1 : (Volume::SizeType)QThread::idealThreadCount();
+	const Volume::SizeType chunks = std::max(std::min(threads, sizeZ), 1u);
+
+	SliceTotals zTotals(sizeZ);
+	QVector<SliceTotals> xTotals((int)chunks, SliceTotals(sizeX));
+	QVector<SliceTotals> yTotals((int)chunks, SliceTotals(sizeY));
+
+	auto body = [&](size_t chunk) {
+
+		TRACE_SCOPE_ARG("statisticsChunk", chunk);
+
+		SliceTotals& xs = xTotals[(int)chunk];
+		SliceTotals& ys = yTotals[(int)chunk];
+
+		qint64* xSum = xs.sum.data();
+		quint64* xSquares = xs.squares.data();
+		Volume::ElementType* xMin = xs.min.data();
+		Volume::ElementType* xMax = xs.max.data();
+		quint32* xHistogram = xs.histogram.data();
+
+		const Volume::IndexType z0 = (Volume::IndexType)((chunk * sizeZ) / chunks);
+		const Volume::IndexType z1 = (Volume::IndexType)(((chunk + 1) * sizeZ) / chunks);
+
+		for (Volume::IndexType z = z0; z < z1; z++)
+		{
+			quint32* zHistogram = zTotals.histogram.data() + ((size_t)z * Bins);
+
+			for (Volume::IndexType y = 0; y < sizeY; y++)
+			{
+				const Volume::ElementType* row = volume->data() + volume->index(0, y, z);
+				quint32* yHistogram = ys.histogram.data() + ((size_t)y * Bins);
+
+				//Row totals and X slice totals, iterations are independent so the loop vectorizes
+				qint64 rowSum = 0;
+				quint64 rowSquares = 0;
+				Volume::ElementType rowMin = std::numeric_limits<Volume::ElementType>::max();
+				Volume::ElementType rowMax = std::numeric_limits<Volume::ElementType>::min();
+
+				for (Volume::IndexType x = 0; x < sizeX; x++)
+				{
+					const qint32 value = row[x];
+					const quint32 square = (quint32)(value * value);
+
+					rowSum += value;
+					rowSquares += square;
+					rowMin = std::min(rowMin, row[x]);
+					rowMax = std::max(rowMax, row[x]);
+
+					xSum[x] += value;
+					xSquares[x] += square;
+					xMin[x] = std::min(xMin[x], row[x]);
+					xMax[x] = std::max(xMax[x], row[x]);
+				}
+
+				//Histograms, each voxel is counted in the slice of every axis it belongs to
+				for (Volume::IndexType x = 0; x < sizeX; x++)
+				{
+					const qint32 bin = ((qint32)(row[x] - minValue) * binScale) >> 16;
+
+					xHistogram[(size_t)x * Bins + bin]++;
+					yHistogram[bin]++;
+					zHistogram[bin]++;
+				}
+
+				//Y slice totals of this chunk
+				ys.sum[y] += rowSum;
+				ys.squares[y] += rowSquares;
+				ys.min[y] = std::min(ys.min[y], rowMin);
+				ys.max[y] = std::max(ys.max[y], rowMax);
+
+				//Z slices belong to one chunk only
+				zTotals.sum[z] += rowSum;
+				zTotals.squares[z] += rowSquares;
+				zTotals.min[z] = std::min(zTotals.min[z], rowMin);
+				zTotals.max[z] = std::max(zTotals.max[z], rowMax);
+			}
+		}
+	};
+
+	if (pool != nullptr)
+	{
+		pool->parallelFor(chunks, priority, body);
+	}
+	else
+	{
+		QtConcurrent::blockingMap(CountingIterator(0), CountingIterator(chunks), body);
+	}
+
+	//Combine the totals of every chunk
+	for (Volume::SizeType chunk = 1; chunk < chunks; chunk++)
+	{
+		xTotals[0].merge(xTotals[(int)chunk]);
+		yTotals[0].merge(yTotals[(int)chunk]);
+	}
+
+	const SliceTotals* totals[3] = { &xTotals[0], &yTotals[0], &zTotals };
+
+	//Voxels in a slice of each axis
+	const quint64 counts[3] =
+	{
+		(quint64)sizeY * sizeZ,
+		(quint64)sizeX * sizeZ,
+		(quint64)sizeX * sizeY
+	};
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const SliceTotals& t = *totals[axis];
+
+		m_slices[axis].resize(t.sum.size());
+		m_histograms[axis] = t.histogram;
+
+		for (int i = 0; i < t.sum.size(); i++)
+		{
+			Summary& s = m_slices[axis][i];
+			s.min = t.min[i];
+			s.max = t.max[i];
+			s.count = counts[axis];
+			s.sum = t.sum[i];
+			s.sumSquares = t.squares[i];
+		}
+	}
+
+	//Whole volume from the Z slices
+	m_total.min = std::numeric_limits<Volume::ElementType>::max();
+	m_total.max = std::numeric_limits<Volume::ElementType>::min();
+	m_totalHistogram.fill(0, Bins);
+
+	for (int z = 0; z < zTotals.sum.size(); z++)
+	{
+		m_total.min = std::min(m_total.min, zTotals.min[z]);
+		m_total.max = std::max(m_total.max, zTotals.max[z]);
+		m_total.count += counts[ZAxis];
+		m_total.sum += zTotals.sum[z];
+		m_total.sumSquares += zTotals.squares[z];
+
+		for (int bin = 0; bin < Bins; bin++)
+		{
+			m_totalHistogram[bin] += zTotals.histogram[z * Bins + bin];
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
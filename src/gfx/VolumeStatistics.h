@@ -0,0 +1,105 @@
+/*
+	Volume statistics class:
+
+	Stores the minimum, maximum, mean, standard deviation and histogram of every slice along each axis,
+	and of the whole volume.
+
+	Everything is computed in one parallel pass over the voxels, after which every query is a lookup.
+	Histograms have a fixed number of bins spread evenly over the value range of the volume.
+*/
+
+#pragma once
+
+#include <QVector>
+
+#include "Volume.h"
+#include "RenderThreadPool.h"
+
+class VolumeStatistics
+{
+public:
+
+	//Number of histogram bins
+	static const int Bins = 256;
+
+	/*
+		Statistics of a set of voxels
+	*/
+	struct Summary
+	{
+		Volume::ElementType min = 0;
+		Volume::ElementType max = 0;
+
+		quint64 count = 0;
+		qint64 sum = 0;
+		quint64 sumSquares = 0;
+
+		double mean() const { return (count > 0) ? ((double)sum / count) : 0.0; }
+		double variance() const;
+		double stddev() const;
+	};
+
+	VolumeStatistics() {}
+
+	/*
+		Compute the statistics of a volume
+
+		Chunks of slices are computed on the given thread pool at the given priority,
+		or on QtConcurrent's global pool if no pool is given.
+	*/
+	explicit VolumeStatistics(const Volume* volume, RenderThreadPool* pool = nullptr, RenderPriority priority = PriorityBackground);
+
+	/*
+		Number of slices along an axis
+	*/
+	Volume::SizeType slices(VolumeAxis axis) const { return (Volume::SizeType)m_slices[axis].size(); }
+
+	/*
+		Statistics of a slice
+	*/
+	const Summary& slice(VolumeAxis axis, Volume::IndexType index) const
+	{
+		Q_ASSERT(index < slices(axis));
+		return m_slices[axis][(int)index];
+	}
+
+	/*
+		Statistics of the whole volume
+	*/
+	const Summary& total() const { return m_total; }
+
+	/*
+		Histogram of a slice, an array of Bins counts
+	*/
+	const quint32* histogram(VolumeAxis axis, Volume::IndexType index) const
+	{
+		Q_ASSERT(index < slices(axis));
+		return m_histograms[axis].constData() + ((size_t)index * Bins);
+	}
+
+	/*
+		Histogram of the whole volume
+	*/
+	const QVector<quint64>& totalHistogram() const { return m_totalHistogram; }
+
+	/*
+		Lowest value counted in a histogram bin
+	*/
+	Volume::ElementType binStart(int bin) const
+	{
+		return (Volume::ElementType)(m_min + ((((qint64)bin << 16) + m_binScale - 1) / m_binScale));
+	}
+
+private:
+
+	//Lowest value of the volume, and the 16.16 fixed point scale from values to bins
+	Volume::ElementType m_min = 0;
+	qint32 m_binScale = 1 << 16;
+
+	//Slices of each axis
+	QVector<Summary> m_slices[3];
+	QVector<quint32> m_histograms[3];
+
+	Summary m_total;
+	QVector<quint64> m_totalHistogram;
+};
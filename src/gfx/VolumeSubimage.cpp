@@ -15,7 +15,7 @@ VolumeSubimage::VolumeSubimage(const Volume* volume, Volume::IndexType index, Vo
 
 	//Weighting values for converting (u,v,w) indices into a single index
 	const Volume::SizeType xWeight = 1;
-	const Volume::SizeType yWeight = volume->sizeY();
+	const Volume::SizeType yWeight = volume->sizeX();
 	const Volume::SizeType zWeight = volume->sizeX() * volume->sizeY();
 
 	//Subimage is pointing along the X axis
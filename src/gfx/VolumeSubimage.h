@@ -64,9 +64,9 @@ private:
 		/*
 			Formala for getting index into 3D array with 3 coordinate components:
 
-			u + (v * sizeY) + (w * sizeY * sizeX)
+			u + (v * sizeX) + (w * sizeX * sizeY)
 
-			the index/u/v weights are set to either 1/sizeY/sizeY*sizeX depending on the axis
+			the index/u/v weights are set to either 1/sizeX/sizeX*sizeY depending on the axis
 		*/
 		return (m_index * m_idxWeight) + (u * m_uWeight) + (v * m_vWeight);
 	}
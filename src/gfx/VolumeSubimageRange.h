@@ -60,6 +60,14 @@ public:
 		m_begin(volume, 0, axis),
 		m_end(volume, volume->axisSize(axis), axis)
 	{}
+
+	/*
+		Construct a range over the subimages [first, last) of an axis
+	*/
+	VolumeSubimageRange(const Volume* volume, VolumeAxis axis, Volume::IndexType first, Volume::IndexType last) :
+		m_begin(volume, first, axis),
+		m_end(volume, last, axis)
+	{}
 	
 	iterator begin() const { return iterator(m_begin); }
 	iterator end() const { return iterator(m_end); }
@@ -9,6 +9,7 @@
 #include <QDebug>
 
 #include "GLVolumeScene.h"
+#include "util/Trace.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -52,6 +53,34 @@ bool GLVolumeScene::buildShaders()
 
 bool GLVolumeScene::buildVolume()
 {
+	//Generate texture
+	glGenTextures(1, &m_tex);
+	glBindTexture(GL_TEXTURE_3D, m_tex);
+
+	/*
+		Setup texture sampling parameters
+	*/
+
+	//Enable trilinear texture filtering
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	//Enable border address wrapping mode
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
+	//Set border colour
+	float color[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	glTexParameterfv(GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, color);
+
+	uploadVolume();
+
+	return true;
+}
+
+void GLVolumeScene::uploadVolume()
+{
+	TRACE_SCOPE("uploadVolume");
+
 	//Texture dimensions
 	GLsizei width = m_volume->sizeX();
 	GLsizei height = m_volume->sizeY();
@@ -77,29 +106,16 @@ bool GLVolumeScene::buildVolume()
 		}
 	}
 
-	//Generate texture
-	glGenTextures(1, &m_tex);
-	glBindTexture(GL_TEXTURE_3D, m_tex);
-
-	/*
-		Setup texture sampling parameters
-	*/
-
-	//Enable trilinear texture filtering
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	//Enable border address wrapping mode
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
-	//Set border colour
-	float color[] = { 0.0f, 0.0f, 0.0f, 1.0f };
-	glTexParameterfv(GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, color);
-
 	//Upload data
+	glBindTexture(GL_TEXTURE_3D, m_tex);
 	glTexImage3D(GL_TEXTURE_3D, 0, GL_RED, width, height, depth, 0, GL_RED, GL_UNSIGNED_BYTE, buffer.data());
+}
 
-	return true;
+void GLVolumeScene::volumeChanged()
+{
+	//Uploaded when the next frame is painted, so a hidden scene does not upload every frame of a series
+	m_volumeDirty = true;
+	update();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -143,6 +159,12 @@ void GLVolumeScene::resizeGL(int w, int h)
 
 void GLVolumeScene::paintGL()
 {
+	if (m_volumeDirty)
+	{
+		uploadVolume();
+		m_volumeDirty = false;
+	}
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	
 	m_program->bind();
@@ -22,6 +22,13 @@ public:
 	
 	~GLVolumeScene();
 
+public slots:
+
+	/*
+		Upload the voxels of the volume again before the next frame, after it was replaced
+	*/
+	void volumeChanged();
+
 private:
 
 	void mousePressEvent(QMouseEvent* e) override;
@@ -35,10 +42,15 @@ private:
 	bool buildShaders();
 	bool buildVolume();
 
+	//Copy the voxels of the volume into the texture
+	void uploadVolume();
+
 	//shader program
 	QOpenGLShaderProgram* m_program = nullptr;
 	//volume texture
 	GLuint m_tex;
+	//texture holds an earlier volume
+	bool m_volumeDirty = false;
 
 	//Uniforms
 	QMatrix4x4 m_modelView;
@@ -13,19 +13,28 @@ CameraView::CameraView(VolumeRender* render, QWidget* parent) :
 	m_render(render),
 	m_width(300),
 	m_height(300),
-	QLabel(parent)
+	m_dirty(this, [this](quint32) { redraw(); }, Inputs3D | InputCamera),
+	ImageView(parent)
 {
 	Q_ASSERT(m_render != nullptr);
 
 	//Setup image widget
-	QLabel::setAlignment(Qt::AlignCenter);
+	ImageView::setSource(&m_buffers);
 	QWidget::setFixedSize(m_width, m_height);
 
 	//default direction
 	m_viewMatrix = QMatrix4x4();
 	m_viewMatrix.rotate(90, 1, 0);
 
-	redraw();
+	//Redraw when render state used by the 3D view changes
+	connect(m_render, &VolumeRender::inputsChanged, this, &CameraView::invalidate);
+
+	invalidate(DirtyState::AllInputs);
+}
+
+void CameraView::invalidate(quint32 inputs)
+{
+	m_dirty.invalidate(inputs);
 }
 
 /*
@@ -34,17 +43,19 @@ CameraView::CameraView(VolumeRender* render, QWidget* parent) :
 void CameraView::redraw()
 {
 	//Prepare buffer
-	m_buffer.realloc(m_width, m_height);
+	ImageBuffer& buffer = m_buffers.back().realloc(m_width, m_height, ImageBuffer::Gray8);
 
 	//Scaling matrix
 	QMatrix4x4 scaling;
 	scaling.scale(1.4f, 1.4f, 1.4f);
 
 	//Render 3D view
-	m_render->draw3D(m_buffer, m_viewMatrix * scaling);
+	const RenderStats stats = m_render->draw3D(buffer, m_viewMatrix * scaling);
+	ImageView::setStatistics(stats, m_render->statistics(Render3D));
 
 	//Present view
-	QLabel::setPixmap(m_buffer.toPixmap());
+	m_buffers.swap();
+	ImageView::present();
 }
 
 QVector3D CameraView::mapToSphere(const QPointF& point)
@@ -100,7 +111,8 @@ void CameraView::mouseMoveEvent(QMouseEvent* event)
 		//Update current point
 		m_curPoint = p1;
 
-		redraw();
+		//Mouse moves within one turn of the event loop are drawn together
+		invalidate(InputCamera);
 	}
 }
 
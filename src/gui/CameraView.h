@@ -7,12 +7,13 @@
 
 #pragma once
 
-#include <QLabel>
 #include <QMatrix4x4>
 
 #include "gfx/VolumeRender.h"
+#include "util/DirtyState.h"
+#include "ImageView.h"
 
-class CameraView : public QLabel
+class CameraView : public ImageView
 {
 	Q_OBJECT
 	Q_DISABLE_COPY(CameraView)
@@ -25,11 +26,26 @@ public:
 	explicit CameraView(VolumeRender* render, QWidget* parent = nullptr);
 
 public slots:
-	
+
+	/*
+		Mark render inputs as changed, the view is redrawn once on the next turn of the event loop
+		if it depends on any of them
+	*/
+	void invalidate(quint32 inputs);
+
+	/*
+		Redraw view immediately
+	*/
 	void redraw();
 	
 private:
 
+	//View state inputs, following the RenderInput flags
+	enum ViewInput
+	{
+		InputCamera = 1 << 16
+	};
+
 	//Input event handlers
 	void mousePressEvent(QMouseEvent* event) override;
 	void mouseMoveEvent(QMouseEvent* event) override;
@@ -46,7 +62,10 @@ private:
 	quint32 m_width;
 	quint32 m_height;
 
-	ImageBuffer m_buffer;
+	ImageSwapChain m_buffers;
+
+	//Changed inputs since the last redraw
+	DirtyState m_dirty;
 	
 	VolumeRender* m_render;
 };
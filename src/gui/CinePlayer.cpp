@@ -0,0 +1,86 @@
+/*
+	Cine player source
+*/
+
+#include "CinePlayer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QString CinePlayer::Statistics::toString() const
+{
+	return QString("%1 fps, %2 shown, %3 dropped")
+		.arg(fps, 0, 'f', 1)
+		.arg(shown)
+		.arg(dropped);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CinePlayer::CinePlayer(QObject* parent) :
+	QObject(parent)
+{
+	m_timer.setTimerType(Qt::PreciseTimer);
+	connect(&m_timer, &QTimer::timeout, this, &CinePlayer::tick);
+}
+
+void CinePlayer::setFrameCount(int count)
+{
+	m_count = std::max(count, 1);
+}
+
+void CinePlayer::setFrameRate(int fps)
+{
+	m_fps = std::max(fps, 1);
+
+	//Restart timing so the new rate applies from the current frame
+	if (playing())
+	{
+		play((int)((m_startFrame + m_lastFrame) % m_count));
+	}
+}
+
+void CinePlayer::play(int frame)
+{
+	m_startFrame = frame % m_count;
+	m_lastFrame = 0;
+	m_lastReport = 0;
+	m_stats = Statistics();
+
+	m_clock.start();
+
+	//Wake up twice per frame so frames are not skipped by timer jitter
+	m_timer.start(std::max(500 / m_fps, 1));
+
+	emit frameChanged(m_startFrame);
+}
+
+void CinePlayer::stop()
+{
+	m_timer.stop();
+}
+
+void CinePlayer::tick()
+{
+	const qint64 elapsed = m_clock.elapsed();
+	const qint64 frame = (elapsed * m_fps) / 1000;
+
+	if (frame == m_lastFrame)
+		return;
+
+	//Frames whose time passed while the previous frame was being shown
+	m_stats.dropped += (quint64)(frame - m_lastFrame - 1);
+	m_stats.shown++;
+	m_lastFrame = frame;
+
+	emit frameChanged((int)((m_startFrame + frame) % m_count));
+
+	if (elapsed - m_lastReport >= 1000)
+	{
+		m_stats.fps = (elapsed > 0) ? (m_stats.shown * 1000.0 / elapsed) : 0.0;
+		m_lastReport = elapsed;
+
+		emit statisticsChanged(m_stats);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+/*
+	Cine player
+
+	Plays through the slices of an axis at a target frame rate by emitting the index to show.
+
+	Frames are chosen from the time elapsed since playback started, so when showing a frame takes
+	longer than the frame period the following frames are skipped and counted as dropped instead
+	of slowing playback down.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class CinePlayer : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(CinePlayer)
+
+public:
+
+	/*
+		Playback counters since playback last started
+	*/
+	struct Statistics
+	{
+		quint64 shown = 0;
+		quint64 dropped = 0;
+		double fps = 0.0; //frames shown per second
+
+		QString toString() const;
+	};
+
+	explicit CinePlayer(QObject* parent = nullptr);
+
+	/*
+		Number of frames, playback loops back to the first frame after the last
+	*/
+	int frameCount() const { return m_count; }
+	void setFrameCount(int count);
+
+	/*
+		Target frames per second
+	*/
+	int frameRate() const { return m_fps; }
+	void setFrameRate(int fps);
+
+	bool playing() const { return m_timer.isActive(); }
+
+	Statistics statistics() const { return m_stats; }
+
+public slots:
+
+	/*
+		Start playing from a frame
+	*/
+	void play(int frame);
+	void stop();
+
+signals:
+
+	//Frame to show
+	void frameChanged(int frame);
+
+	//Emitted about once a second while playing
+	void statisticsChanged(const CinePlayer::Statistics& stats);
+
+private:
+
+	void tick();
+
+	QTimer m_timer;
+	QElapsedTimer m_clock;
+
+	int m_count = 1;
+	int m_fps = 30;
+
+	int m_startFrame = 0;
+	qint64 m_lastFrame = 0; //frames since start, not wrapped
+	qint64 m_lastReport = 0;
+
+	Statistics m_stats;
+};
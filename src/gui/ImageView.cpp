@@ -0,0 +1,139 @@
+/*
+	Image View widget source
+*/
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include "ImageView.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ImageView::ImageView(QWidget* parent) :
+	QWidget(parent)
+{
+	//Every pixel is painted by the image or the background
+	QWidget::setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void ImageView::setSource(const ImageSwapChain* source)
+{
+	m_source = source;
+	present();
+}
+
+void ImageView::present()
+{
+	QSize size = (m_source != nullptr) ?
+		QSize((int)m_source->front().width(), (int)m_source->front().height()) :
+		QSize();
+
+	if (m_displaySize.isValid())
+	{
+		size = m_displaySize;
+	}
+
+	//Layout only needs updating when the image dimensions change
+	if (size != m_imageSize)
+	{
+		m_imageSize = size;
+		QWidget::setMinimumSize(m_imageSize);
+		QWidget::updateGeometry();
+	}
+
+	QWidget::update();
+}
+
+void ImageView::setStatistics(const RenderStats& last, const RenderStatistics& rolling)
+{
+	const RenderStats average = rolling.average();
+
+	m_statistics = last.toString() + QString("\navg %1 ms, %2 samples")
+		.arg(average.wallTimeMs(), 0, 'f', 2)
+		.arg(average.samples);
+
+	if (m_showStatistics)
+	{
+		QWidget::update();
+	}
+}
+
+void ImageView::setStatisticsVisible(bool visible)
+{
+	m_showStatistics = visible;
+	QWidget::update();
+}
+
+QSize ImageView::sizeHint() const
+{
+	return m_imageSize;
+}
+
+QRect ImageView::visibleImageRect() const
+{
+	const QRect visible = QWidget::visibleRegion().boundingRect().translated(-imageOrigin());
+	return visible & QRect(QPoint(), m_imageSize);
+}
+
+QPoint ImageView::imageOrigin() const
+{
+	//Image is centered in the widget
+	QRect target(QPoint(), m_imageSize);
+	target.moveCenter(rect().center());
+	return target.topLeft();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ImageView::paintEvent(QPaintEvent* event)
+{
+	QPainter painter(this);
+
+	painter.fillRect(rect(), palette().window());
+
+	if (m_source == nullptr)
+		return;
+
+	const QPoint origin = imageOrigin();
+	const QRect bounds(QPoint(), m_imageSize);
+
+	if (m_partial)
+	{
+		//Let the owner draw parts of the image which are not drawn yet
+		const QRect needed = event->rect().translated(-origin) & bounds;
+
+		if (!needed.isEmpty() && !(QRegion(needed) - m_valid).isEmpty())
+		{
+			emit exposed(needed);
+		}
+
+		painter.setClipRegion(m_valid.translated(origin));
+	}
+
+	//Wraps the front buffer without copying
+	const QImage image = m_source->front().toImage();
+
+	if (image.size() == m_imageSize)
+	{
+		painter.drawImage(origin, image);
+	}
+	else
+	{
+		//Scaled up without filtering, previews are replaced as soon as the full image is drawn
+		Q_ASSERT(!m_partial);
+		painter.drawImage(QRect(origin, m_imageSize), image);
+	}
+	painter.setClipping(false);
+
+	if (m_showStatistics && !m_statistics.isEmpty())
+	{
+		//Text over translucent background in the top left corner
+		const QRect bounds = painter.fontMetrics().boundingRect(rect().adjusted(4, 4, -4, -4), Qt::AlignLeft | Qt::AlignTop, m_statistics);
+
+		painter.fillRect(bounds.adjusted(-2, -2, 2, 2), QColor(0, 0, 0, 160));
+		painter.setPen(Qt::yellow);
+		painter.drawText(bounds, Qt::AlignLeft | Qt::AlignTop, m_statistics);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
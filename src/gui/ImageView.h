@@ -0,0 +1,107 @@
+/*
+	Image View widget
+
+	Presents the front buffer of an image swap chain.
+
+	The buffer is painted directly, no intermediate pixmap is created.
+	Optionally render statistics are painted over the image.
+
+	Only part of the image may have been drawn. Parts of the image which need painting but are
+	not drawn yet are announced with the exposed signal before painting, so the owner can fill them in.
+*/
+
+#pragma once
+
+#include <QWidget>
+#include <QRegion>
+
+#include "gfx/ImageBuffer.h"
+#include "gfx/RenderStatistics.h"
+
+class ImageView : public QWidget
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(ImageView)
+
+public:
+
+	/*
+		Construct an image view widget
+	*/
+	explicit ImageView(QWidget* parent = nullptr);
+
+	/*
+		Set the swap chain to present
+	*/
+	void setSource(const ImageSwapChain* source);
+
+	/*
+		Present the current front buffer
+	*/
+	void present();
+
+	/*
+		Set the size the image is shown at, an invalid size shows the image at its own size.
+
+		Images smaller than the display size, such as previews drawn at reduced resolution, are scaled up.
+		Scaled images must be wholly valid.
+	*/
+	void setDisplaySize(const QSize& size) { m_displaySize = size; }
+
+	/*
+		Set the region of the front buffer which holds a drawn image, in image coordinates.
+
+		By default the whole image is valid.
+	*/
+	void setValidRegion(const QRegion& region) { m_valid = region; m_partial = true; }
+	void setWholeImageValid() { m_valid = QRegion(); m_partial = false; }
+
+	const QRegion& validRegion() const { return m_valid; }
+
+	/*
+		Part of the image visible on screen, in image coordinates
+	*/
+	QRect visibleImageRect() const;
+
+	/*
+		Set the statistics shown in the overlay
+	*/
+	void setStatistics(const RenderStats& last, const RenderStatistics& rolling);
+
+	bool statisticsVisible() const { return m_showStatistics; }
+
+	QSize sizeHint() const override;
+
+public slots:
+
+	/*
+		Show/hide the statistics overlay
+	*/
+	void setStatisticsVisible(bool visible);
+
+signals:
+
+	/*
+		Emitted while painting when part of the image outside the valid region is about to be painted, in image coordinates
+	*/
+	void exposed(const QRect& rect);
+
+protected:
+
+	void paintEvent(QPaintEvent* event) override;
+
+private:
+
+	//Position of the image in the widget
+	QPoint imageOrigin() const;
+
+	const ImageSwapChain* m_source = nullptr;
+	QSize m_imageSize;
+	QSize m_displaySize;
+	QRegion m_valid;
+	bool m_partial = false;
+
+	//Statistics overlay
+	bool m_showStatistics = false;
+	QString m_statistics;
+};
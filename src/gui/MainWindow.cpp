@@ -7,13 +7,21 @@
 #include "MainWindow.h"
 
 #include "gfx/VolumeRender.h"
+#include "gfx/VolumeSeries.h"
+#include "gfx/VolumeFilter.h"
+#include "gfx/VolumeLoader.h"
 
 #include "SubimageView.h"
 #include "CameraView.h"
+#include "ObliqueView.h"
+#include "StatisticsPanel.h"
 #include "LabelledSlider.h"
+#include "CinePlayer.h"
 
 #include "gl/GLVolumeScene.h"
 
+#include "util/Trace.h"
+
 enum Constants
 {
 	IMAGE_SCALE_MIN = 10,
@@ -22,15 +30,25 @@ enum Constants
 	CTRL_WIDGET_WIDTH_MAX = 400,
 	RAYCAST_FREQUENCY_MIN = 10,
 	RAYCAST_FREQUENCY_MAX = 400,
+	CINE_FPS_MIN = 1,
+	CINE_FPS_MAX = 120,
+	CINE_FPS_DEFAULT = 30,
+	CINE_PREFETCH_MAX = 64,
+	CINE_PREFETCH_DEFAULT = 8,
+	SERIES_FPS_DEFAULT = 10,
+	FILTER_SIZE_MIN = 0,
+	FILTER_SIZE_MAX = 8,
 	WINDOW_DEFAULT_WIDTH = 1064,
 	WINDOW_DEFAULT_HEIGHT = 720
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-MainWindow::MainWindow(Volume& volume, QWidget *parent) :
+MainWindow::MainWindow(Volume& volume, VolumeSeries* series, QWidget *parent) :
 	QMainWindow(parent),
-	m_render(volume)
+	m_render(volume),
+	m_series(series),
+	m_unfiltered(*m_render.volume())
 {
 	setWindowTitle(QStringLiteral("CT Viewer"));
 	resize(QSize(WINDOW_DEFAULT_WIDTH, WINDOW_DEFAULT_HEIGHT));
@@ -40,10 +58,21 @@ MainWindow::MainWindow(Volume& volume, QWidget *parent) :
 	QWidget* standardView = createWidgets();
 	m_glView = new GLVolumeScene(m_render.volume(), tab);
 
+	//The GL view keeps its own copy of the voxels in a texture
+	connect(&m_render, &VolumeRender::inputsChanged, this, [this](quint32 inputs) {
+		if (inputs & InputVolume)
+			m_glView->volumeChanged();
+	});
+
 	tab->addTab(standardView, QStringLiteral("Standard View"));
 	tab->addTab(m_glView, QStringLiteral("GL View"));
 
 	setCentralWidget(tab);
+
+	//Statistics of the current slices
+	QDockWidget* statisticsDock = new QDockWidget(QStringLiteral("Slice Statistics"), this);
+	statisticsDock->setWidget(m_statisticsPanel);
+	addDockWidget(Qt::RightDockWidgetArea, statisticsDock);
 }
 
 MainWindow::~MainWindow()
@@ -60,11 +89,251 @@ void MainWindow::scaleImages(int value)
 	//Scale percentage value to normalized value
 	float scaleFactor = std::max((float)value / 100.0f, 0.0f);
 
+	//Each view is redrawn once on the next turn of the event loop
 	m_xSubimage->setScale(scaleFactor);
 	m_ySubimage->setScale(scaleFactor);
 	m_zSubimage->setScale(scaleFactor);
+}
+
+void MainWindow::saveTrace()
+{
+	const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Save Trace"), QStringLiteral("trace.json"), QStringLiteral("Chrome Trace (*.json)"));
+
+	if (path.isEmpty())
+		return;
+
+	QString error;
+
+	if (!Trace::write(path, &error))
+	{
+		QMessageBox::warning(this, QStringLiteral("Save Trace"), error);
+	}
+}
+
+void MainWindow::playCine(bool play)
+{
+	if (!play)
+	{
+		m_cine->stop();
+		m_cinePlay->setText(QStringLiteral("Play"));
+		return;
+	}
+
+	const VolumeAxis axis = (VolumeAxis)m_cineAxis->currentIndex();
+	LabelledSlider* slider = axisSlider(axis);
+
+	axisSubimage(axis)->resetPrefetchStatistics();
+
+	m_cine->setFrameRate(m_cineRate->value());
+	m_cine->setFrameCount(slider->maximum() + 1);
+	m_cine->play(slider->value());
+
+	m_cinePlay->setText(QStringLiteral("Stop"));
+}
+
+void MainWindow::showCineFrame(int frame)
+{
+	axisSlider((VolumeAxis)m_cineAxis->currentIndex())->setValue(frame);
+}
+
+void MainWindow::updateClipRegion()
+{
+	QVector3D min, max;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		min[axis] = m_clipMin[axis]->value() / 100.0f;
+		max[axis] = m_clipMax[axis]->value() / 100.0f;
+	}
+
+	ClipRegion region;
+	region.setBox(AABB(min, max));
+
+	//Keep the part of the volume in front of the oblique plane
+	if (m_clipOblique->isChecked())
+	{
+		const ObliqueSlice& slice = m_obliqueView->slice();
+		region.addPlane(Plane::fromPoint(slice.centre(), slice.normal()));
+	}
+
+	m_render.setClipRegion(region);
+
+	measureClipBox();
+}
+
+void MainWindow::resetClipRegion()
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		QSignalBlocker blockMin(m_clipMin[axis]);
+		QSignalBlocker blockMax(m_clipMax[axis]);
+
+		//The blocked signals also keep the bounds from updating each other's range
+		m_clipMin[axis]->setRange(0, 100);
+		m_clipMax[axis]->setRange(0, 100);
+
+		m_clipMin[axis]->setValue(0);
+		m_clipMax[axis]->setValue(100);
+	}
+
+	QSignalBlocker blockOblique(m_clipOblique);
+	m_clipOblique->setChecked(false);
+
+	updateClipRegion();
+}
+
+void MainWindow::growRegion()
+{
+	RegionGrowing::Options options;
+	options.lower = (Volume::ElementType)m_segmentLower->value();
+	options.upper = (Volume::ElementType)m_segmentUpper->value();
+	options.connectivity = (Connectivity)m_segmentConnectivity->currentIndex();
+
+	const RenderStats stats = m_render.growRegion(
+		(Volume::IndexType)m_xSlider->value(),
+		(Volume::IndexType)m_ySlider->value(),
+		(Volume::IndexType)m_zSlider->value(),
+		options
+	);
+
+	const quint64 count = m_render.maskCount();
+
+	if (count == 0)
+	{
+		m_segmentInfo->setText(QStringLiteral("Seed voxel is outside the range"));
+		return;
+	}
+
+	m_segmentInfo->setText(QStringLiteral("%1 voxels in %2 ms").arg(count).arg(stats.wallTimeMs(), 0, 'f', 1));
+}
+
+void MainWindow::applyFilter()
+{
+	m_render.setVolume(filterFrame(m_unfiltered));
+}
+
+Volume MainWindow::filterFrame(const Volume& frame)
+{
+	//The first entry is no filter
+	const int type = m_filterType->currentIndex() - 1;
+
+	if (type < 0)
+	{
+		m_filterInfo->clear();
+		return frame;
+	}
+
+	VolumeFilter::Options options;
+	options.type = (FilterType)type;
+	options.sigma = (float)m_filterSize->value();
+	options.radius = (int)m_filterSize->value();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	RenderCounters counters;
+	Volume filtered = VolumeFilter::apply(frame, options, &counters, m_render.threadPool(), PriorityInteractive);
+
+	const RenderStats stats = counters.stats(timer.nsecsElapsed());
+
+	m_filterInfo->setText(QStringLiteral("%1 ms, %2 Mvoxels/s")
+		.arg(stats.wallTimeMs(), 0, 'f', 1)
+		.arg(stats.pixels / (stats.wallTimeMs() * 1000.0), 0, 'f', 1)
+	);
 
-	m_render.redraw2D();
+	return filtered;
+}
+
+void MainWindow::saveVolume()
+{
+	const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Save Volume"), QStringLiteral("filtered.ini"), QStringLiteral("Volume Config (*.ini)"));
+
+	if (path.isEmpty())
+		return;
+
+	QString error;
+
+	if (!VolumeLoader::save(path, *m_render.volume(), &error))
+	{
+		QMessageBox::warning(this, QStringLiteral("Save Volume"), error);
+	}
+}
+
+void MainWindow::measureClipBox()
+{
+	const QVector3D min(m_clipMin[0]->value(), m_clipMin[1]->value(), m_clipMin[2]->value());
+	const QVector3D max(m_clipMax[0]->value(), m_clipMax[1]->value(), m_clipMax[2]->value());
+
+	//Constant time whatever the size of the box, so it can follow every change of the bounds
+	const SummedVolumeTable::Totals totals = m_render.summedVolume().box(AABB(min / 100.0f, max / 100.0f));
+
+	m_clipMeasure->setText(QStringLiteral("Box mean %1, std dev %2 (%3 voxels)")
+		.arg(totals.mean(), 0, 'f', 1)
+		.arg(totals.stddev(), 0, 'f', 1)
+		.arg(totals.count)
+	);
+}
+
+void MainWindow::playSeries(bool play)
+{
+	if (!play)
+	{
+		m_timePlayer->stop();
+		m_timePlay->setText(QStringLiteral("Play"));
+		return;
+	}
+
+	m_series->resetStatistics();
+
+	m_timePlayer->setFrameRate(m_timeRate->value());
+	m_timePlayer->setFrameCount(m_series->frameCount());
+	m_timePlayer->play(m_timeSlider->value());
+
+	m_timePlay->setText(QStringLiteral("Stop"));
+}
+
+void MainWindow::showTimePoint(int index)
+{
+	//Playback only moves forwards, even when wrapping around to the first frame
+	const int direction = (m_timePlayer->playing() || index >= m_timePoint) ? 1 : -1;
+
+	Volume frame;
+	QString error;
+
+	if (!m_series->frame(index, frame, &error))
+	{
+		m_timeStats->setText(error);
+		return;
+	}
+
+	m_timePoint = index;
+
+	//Views are redrawn on the next turn of the event loop, while the frames after this one are read
+	m_unfiltered = frame;
+	m_render.setVolume(filterFrame(frame));
+	m_series->prefetch(index, direction);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LabelledSlider* MainWindow::axisSlider(VolumeAxis axis) const
+{
+	switch (axis)
+	{
+	case XAxis: return m_xSlider;
+	case YAxis: return m_ySlider;
+	default:    return m_zSlider;
+	}
+}
+
+SubimageView* MainWindow::axisSubimage(VolumeAxis axis) const
+{
+	switch (axis)
+	{
+	case XAxis: return m_xSubimage;
+	case YAxis: return m_ySubimage;
+	default:    return m_zSubimage;
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -77,6 +346,8 @@ QWidget* MainWindow::createWidgets()
 	center->layout()->addWidget(createControlArea());
 	center->layout()->addWidget(createImageArea());
 
+	m_statisticsPanel = new StatisticsPanel(&m_render, this);
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//	Setup signals/slots
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -86,14 +357,137 @@ QWidget* MainWindow::createWidgets()
 	connect(m_ySlider, &QSlider::valueChanged, m_ySubimage, &SubimageView::setIndex);
 	connect(m_zSlider, &QSlider::valueChanged, m_zSubimage, &SubimageView::setIndex);
 
+	//Statistics follow the current slices
+	connect(m_xSlider, &QSlider::valueChanged, [this](int index) { m_statisticsPanel->setSlice(XAxis, (Volume::IndexType)index); });
+	connect(m_ySlider, &QSlider::valueChanged, [this](int index) { m_statisticsPanel->setSlice(YAxis, (Volume::IndexType)index); });
+	connect(m_zSlider, &QSlider::valueChanged, [this](int index) { m_statisticsPanel->setSlice(ZAxis, (Volume::IndexType)index); });
+
 	connect(m_scaleSlider, &QSlider::valueChanged, this, &MainWindow::scaleImages);
 
+	//Views draw previews while the slider driving them is dragged
+	auto previewWhileDragged = [this](QSlider* slider, SubimageView* view) {
+		connect(slider, &QSlider::sliderPressed, view, [view]() { view->setInteracting(true); });
+		connect(slider, &QSlider::sliderReleased, view, [view]() { view->setInteracting(false); });
+	};
+
+	previewWhileDragged(m_xSlider, m_xSubimage);
+	previewWhileDragged(m_ySlider, m_ySubimage);
+	previewWhileDragged(m_zSlider, m_zSubimage);
+	previewWhileDragged(m_scaleSlider, m_xSubimage);
+	previewWhileDragged(m_scaleSlider, m_ySubimage);
+	previewWhileDragged(m_scaleSlider, m_zSubimage);
+
 	//Connect rendering options
 	connect(m_heToggle, &QCheckBox::toggled, &m_render, &VolumeRender::enableHist);
+	connect(m_aheToggle, &QCheckBox::toggled, &m_render, &VolumeRender::enableAdaptiveHist);
 	connect(m_mipToggle, &QCheckBox::toggled, m_xSubimage, &SubimageView::useMIP);
 	connect(m_mipToggle, &QCheckBox::toggled, m_ySubimage, &SubimageView::useMIP);
 	connect(m_mipToggle, &QCheckBox::toggled, m_zSubimage, &SubimageView::useMIP);
 
+	//Render statistics overlays
+	connect(m_statsToggle, &QCheckBox::toggled, m_xSubimage, &SubimageView::showStatistics);
+	connect(m_statsToggle, &QCheckBox::toggled, m_ySubimage, &SubimageView::showStatistics);
+	connect(m_statsToggle, &QCheckBox::toggled, m_zSubimage, &SubimageView::showStatistics);
+	connect(m_statsToggle, &QCheckBox::toggled, m_3DView, &CameraView::setStatisticsVisible);
+	connect(m_statsToggle, &QCheckBox::toggled, m_obliqueView, &ObliqueView::setStatisticsVisible);
+
+	//Tracing
+	connect(m_traceToggle, &QCheckBox::toggled, [](bool enable) {
+		//Start a new recording
+		if (enable)
+			Trace::clear();
+
+		Trace::setEnabled(enable);
+	});
+	connect(m_traceSave, &QPushButton::clicked, this, &MainWindow::saveTrace);
+
+	//Cine playback
+	connect(m_cinePlay, &QPushButton::toggled, this, &MainWindow::playCine);
+	connect(m_cine, &CinePlayer::frameChanged, this, &MainWindow::showCineFrame);
+	connect(m_cineRate, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_cine, &CinePlayer::setFrameRate);
+	connect(m_cineAxis, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this]() {
+		//Restart on the new axis
+		if (m_cinePlay->isChecked())
+			playCine(true);
+	});
+	auto setPrefetchCount = [this](int count) {
+		m_xSubimage->setPrefetchCount(count);
+		m_ySubimage->setPrefetchCount(count);
+		m_zSubimage->setPrefetchCount(count);
+	};
+	connect(m_cinePrefetch, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), setPrefetchCount);
+	setPrefetchCount(m_cinePrefetch->value());
+	connect(m_cine, &CinePlayer::statisticsChanged, [this](const CinePlayer::Statistics& stats) {
+		const SubimageView* view = axisSubimage((VolumeAxis)m_cineAxis->currentIndex());
+
+		m_cineStats->setText(QString("%1\nprefetched %2, drawn %3")
+			.arg(stats.toString())
+			.arg(view->prefetchHits())
+			.arg(view->prefetchMisses())
+		);
+	});
+
+	//Region of interest
+	for (int axis = 0; axis < 3; axis++)
+	{
+		connect(m_clipMin[axis], static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MainWindow::updateClipRegion);
+		connect(m_clipMax[axis], static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MainWindow::updateClipRegion);
+
+		//Keep the lower bound below the upper bound
+		connect(m_clipMin[axis], static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_clipMax[axis], &QSpinBox::setMinimum);
+		connect(m_clipMax[axis], static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_clipMin[axis], &QSpinBox::setMaximum);
+	}
+
+	connect(m_clipOblique, &QCheckBox::toggled, this, &MainWindow::updateClipRegion);
+	connect(m_clipReset, &QPushButton::clicked, this, &MainWindow::resetClipRegion);
+	connect(m_obliqueView, &ObliqueView::sliceChanged, [this]() {
+		if (m_clipOblique->isChecked())
+			updateClipRegion();
+	});
+
+	//Filtering
+	connect(m_filterApply, &QPushButton::clicked, this, &MainWindow::applyFilter);
+	connect(m_filterSave, &QPushButton::clicked, this, &MainWindow::saveVolume);
+
+	//Segmentation
+	connect(m_segmentLower, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_segmentUpper, &QSpinBox::setMinimum);
+	connect(m_segmentUpper, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_segmentLower, &QSpinBox::setMaximum);
+	connect(m_segmentGrow, &QPushButton::clicked, this, &MainWindow::growRegion);
+	connect(m_segmentClear, &QPushButton::clicked, [this]() {
+		m_render.clearMask();
+		m_segmentInfo->clear();
+	});
+
+	//Measurements of a replaced volume are marked out of date rather than rebuilding the summed volume table
+	//on the GUI thread for every frame, the next change of the box measures the new volume
+	connect(&m_render, &VolumeRender::inputsChanged, this, [this](quint32 inputs) {
+		if ((inputs & InputVolume) && !m_clipMeasure->text().isEmpty())
+			m_clipMeasure->setText(QStringLiteral("Volume changed, adjust the box to measure again"));
+	});
+
+	//Time series playback
+	if (m_series != nullptr)
+	{
+		connect(m_timeSlider, &QSlider::valueChanged, this, &MainWindow::showTimePoint);
+		connect(m_timePlay, &QPushButton::toggled, this, &MainWindow::playSeries);
+		connect(m_timePlayer, &CinePlayer::frameChanged, m_timeSlider, &QSlider::setValue);
+		connect(m_timeRate, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_timePlayer, &CinePlayer::setFrameRate);
+		connect(m_timePlayer, &CinePlayer::statisticsChanged, [this](const CinePlayer::Statistics& stats) {
+			m_timeStats->setText(stats.toString() + "\n" + m_series->statistics().toString());
+		});
+
+		//Start reading the frames after the first
+		m_series->prefetch(0, 1);
+	}
+
+	//Sliders are driven by the player during playback
+	connect(m_mipToggle, &QCheckBox::toggled, [this](bool mip) {
+		if (mip)
+			m_cinePlay->setChecked(false);
+
+		m_cinePlay->setDisabled(mip);
+	});
+
 	//When MIP is enabled, disable the view sliders
 	connect(m_mipToggle, &QCheckBox::toggled, m_xSlider, &QSlider::setDisabled);
 	connect(m_mipToggle, &QCheckBox::toggled, m_ySlider, &QSlider::setDisabled);
@@ -107,15 +501,27 @@ QWidget* MainWindow::createWidgets()
 	connect(m_samplerBasic3D, &QRadioButton::clicked, &m_render, &VolumeRender::setSamplingType3DBasic);
 	connect(m_samplerTrilinear, &QRadioButton::clicked, &m_render, &VolumeRender::setSamplingTypeTrilinear);
 
+	connect(m_isotropicToggle, &QCheckBox::toggled, &m_render, &VolumeRender::enableIsotropic);
+	connect(m_isotropicKernel, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int kernel) {
+		m_render.setResampleKernel((ResampleKernel)kernel);
+	});
+
+	//Resampling may also be enabled from the config file
+	connect(&m_render, &VolumeRender::inputsChanged, this, [this](quint32 inputs) {
+		if (inputs & InputResampling)
+		{
+			QSignalBlocker blockToggle(m_isotropicToggle);
+			QSignalBlocker blockKernel(m_isotropicKernel);
+			m_isotropicToggle->setChecked(m_render.isotropicEnabled());
+			m_isotropicKernel->setCurrentIndex(m_render.resampleKernel());
+		}
+	});
+
 	//3D sample frequency slider
 	connect(m_3DSampleSlider, &LabelledSlider::valueChanged, &m_render, &VolumeRender::setSampleFrequency);
 
-	//Connect redraw signals - subimage widgets are redrawn when renderer is updated
-	connect(&m_render, &VolumeRender::redraw2D, m_xSubimage, &SubimageView::redraw);
-	connect(&m_render, &VolumeRender::redraw2D, m_ySubimage, &SubimageView::redraw);
-	connect(&m_render, &VolumeRender::redraw2D, m_zSubimage, &SubimageView::redraw);
-
-	connect(&m_render, &VolumeRender::redraw3D, m_3DView, &CameraView::redraw);
+	//Views invalidate themselves when the renderer inputs they depend on change,
+	//and are redrawn at most once per turn of the event loop
 
 	m_xSlider->setSliderPosition((int)m_render.volume()->sizeX() / 2);
 	m_ySlider->setSliderPosition((int)m_render.volume()->sizeY() / 2);
@@ -136,12 +542,16 @@ QWidget* MainWindow::createImageArea()
 	//3D view
 	m_3DView = new CameraView(&m_render, this);
 
+	//Oblique slice view
+	m_obliqueView = new ObliqueView(&m_render, this);
+
 	//Image grid
 	QGridLayout* imageLayout = new QGridLayout(this);
 	imageLayout->addWidget(m_zSubimage, 0, 0);
 	imageLayout->addWidget(m_ySubimage, 0, 1);
 	imageLayout->addWidget(m_xSubimage, 1, 0);
 	imageLayout->addWidget(m_3DView,    1, 1);
+	imageLayout->addWidget(m_obliqueView, 2, 0);
 
 	QWidget* viewport = new QWidget(this);
 	viewport->setLayout(imageLayout);
@@ -154,6 +564,141 @@ QWidget* MainWindow::createImageArea()
 	return scroll;
 }
 
+QWidget* MainWindow::createSegmentControls()
+{
+	QGroupBox* segmentGroup = new QGroupBox(QStringLiteral("Segmentation:"), this);
+
+	const Volume* volume = m_render.volume();
+
+	m_segmentLower = new QSpinBox(segmentGroup);
+	m_segmentLower->setRange(volume->min(), volume->max());
+	m_segmentLower->setValue((volume->min() + volume->max()) / 2);
+
+	m_segmentUpper = new QSpinBox(segmentGroup);
+	m_segmentUpper->setRange(volume->min(), volume->max());
+	m_segmentUpper->setValue(volume->max());
+
+	m_segmentConnectivity = new QComboBox(segmentGroup);
+	m_segmentConnectivity->addItems({ QStringLiteral("6 (faces)"), QStringLiteral("18 (edges)"), QStringLiteral("26 (corners)") });
+	m_segmentConnectivity->setCurrentIndex(ConnectFaces);
+
+	m_segmentGrow = new QPushButton(QStringLiteral("Grow from Slices"), segmentGroup);
+	m_segmentGrow->setToolTip(QStringLiteral("Grow a region from the voxel where the X, Y and Z slices meet, the 3D view only shows the region"));
+	m_segmentClear = new QPushButton(QStringLiteral("Clear"), segmentGroup);
+
+	m_segmentInfo = new QLabel(segmentGroup);
+
+	QHBoxLayout* rangeLayout = new QHBoxLayout();
+	rangeLayout->addWidget(m_segmentLower);
+	rangeLayout->addWidget(m_segmentUpper);
+
+	QHBoxLayout* buttonLayout = new QHBoxLayout();
+	buttonLayout->addWidget(m_segmentGrow);
+	buttonLayout->addWidget(m_segmentClear);
+
+	QFormLayout* segmentLayout = new QFormLayout(segmentGroup);
+	segmentLayout->addRow(QStringLiteral("Range"), rangeLayout);
+	segmentLayout->addRow(QStringLiteral("Neighbours"), m_segmentConnectivity);
+	segmentLayout->addRow(buttonLayout);
+	segmentLayout->addRow(m_segmentInfo);
+
+	return segmentGroup;
+}
+
+QWidget* MainWindow::createFilterControls()
+{
+	QGroupBox* filterGroup = new QGroupBox(QStringLiteral("Filter:"), this);
+
+	m_filterType = new QComboBox(filterGroup);
+	m_filterType->addItems({ QStringLiteral("None"), QStringLiteral("Gaussian"), QStringLiteral("Box"), QStringLiteral("Median 3x3x3") });
+
+	m_filterSize = new QDoubleSpinBox(filterGroup);
+	m_filterSize->setRange(FILTER_SIZE_MIN, FILTER_SIZE_MAX);
+	m_filterSize->setSingleStep(0.5);
+	m_filterSize->setValue(1.0);
+	m_filterSize->setToolTip(QStringLiteral("Standard deviation of the Gaussian filter, radius of the box filter, in voxels"));
+
+	m_filterApply = new QPushButton(QStringLiteral("Apply"), filterGroup);
+	m_filterSave = new QPushButton(QStringLiteral("Save..."), filterGroup);
+
+	m_filterInfo = new QLabel(filterGroup);
+
+	QHBoxLayout* buttonLayout = new QHBoxLayout();
+	buttonLayout->addWidget(m_filterApply);
+	buttonLayout->addWidget(m_filterSave);
+
+	QFormLayout* filterLayout = new QFormLayout(filterGroup);
+	filterLayout->addRow(QStringLiteral("Type"), m_filterType);
+	filterLayout->addRow(QStringLiteral("Size"), m_filterSize);
+	filterLayout->addRow(buttonLayout);
+	filterLayout->addRow(m_filterInfo);
+
+	return filterGroup;
+}
+
+QWidget* MainWindow::createClipControls()
+{
+	QGroupBox* clipGroup = new QGroupBox(QStringLiteral("Region of Interest (%):"), this);
+
+	QGridLayout* clipLayout = new QGridLayout(clipGroup);
+
+	const QString axisNames[3] = { QStringLiteral("X"), QStringLiteral("Y"), QStringLiteral("Z") };
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		m_clipMin[axis] = new QSpinBox(clipGroup);
+		m_clipMin[axis]->setRange(0, 100);
+		m_clipMin[axis]->setValue(0);
+
+		m_clipMax[axis] = new QSpinBox(clipGroup);
+		m_clipMax[axis]->setRange(0, 100);
+		m_clipMax[axis]->setValue(100);
+
+		clipLayout->addWidget(new QLabel(axisNames[axis], clipGroup), axis, 0);
+		clipLayout->addWidget(m_clipMin[axis], axis, 1);
+		clipLayout->addWidget(m_clipMax[axis], axis, 2);
+	}
+
+	m_clipOblique = new QCheckBox(QStringLiteral("Clip at Oblique Plane"), clipGroup);
+	m_clipReset = new QPushButton(QStringLiteral("Reset"), clipGroup);
+
+	clipLayout->addWidget(m_clipOblique, 3, 0, 1, 2);
+	clipLayout->addWidget(m_clipReset, 3, 2);
+
+	m_clipMeasure = new QLabel(clipGroup);
+	clipLayout->addWidget(m_clipMeasure, 4, 0, 1, 3);
+
+	return clipGroup;
+}
+
+QWidget* MainWindow::createSeriesControls()
+{
+	QGroupBox* seriesGroup = new QGroupBox(QStringLiteral("Time Series:"), this);
+
+	m_timePlayer = new CinePlayer(this);
+
+	m_timeSlider = new LabelledSlider(seriesGroup);
+	m_timeSlider->setRange(0, m_series->frameCount() - 1);
+
+	m_timeRate = new QSpinBox(seriesGroup);
+	m_timeRate->setRange(CINE_FPS_MIN, CINE_FPS_MAX);
+	m_timeRate->setValue(SERIES_FPS_DEFAULT);
+	m_timeRate->setSuffix(QStringLiteral(" fps"));
+
+	m_timePlay = new QPushButton(QStringLiteral("Play"), seriesGroup);
+	m_timePlay->setCheckable(true);
+
+	m_timeStats = new QLabel(seriesGroup);
+
+	QFormLayout* seriesLayout = new QFormLayout(seriesGroup);
+	seriesLayout->addRow(QStringLiteral("Frame"), m_timeSlider);
+	seriesLayout->addRow(QStringLiteral("Rate"), m_timeRate);
+	seriesLayout->addRow(m_timePlay);
+	seriesLayout->addRow(m_timeStats);
+
+	return seriesGroup;
+}
+
 QWidget* MainWindow::createControlArea()
 {
 	///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -180,6 +725,48 @@ QWidget* MainWindow::createControlArea()
 
 	m_mipToggle = new QCheckBox(QStringLiteral("Maximum Intensity Projection"), this);
 	m_heToggle = new QCheckBox(QStringLiteral("Histogram Equalization"), this);
+	m_aheToggle = new QCheckBox(QStringLiteral("Adaptive Histogram Equalization (CLAHE)"), this);
+	m_statsToggle = new QCheckBox(QStringLiteral("Show Render Statistics"), this);
+
+	//Tracing
+	m_traceToggle = new QCheckBox(QStringLiteral("Record Trace"), this);
+	m_traceToggle->setChecked(Trace::enabled());
+	m_traceSave = new QPushButton(QStringLiteral("Save Trace..."), this);
+
+	QHBoxLayout* traceLayout = new QHBoxLayout();
+	traceLayout->addWidget(m_traceToggle);
+	traceLayout->addWidget(m_traceSave);
+
+	//Cine playback
+	QGroupBox* cineGroup = new QGroupBox(QStringLiteral("Cine:"), this);
+
+	m_cine = new CinePlayer(this);
+
+	m_cineAxis = new QComboBox(cineGroup);
+	m_cineAxis->addItems({ QStringLiteral("X"), QStringLiteral("Y"), QStringLiteral("Z") });
+	m_cineAxis->setCurrentIndex(ZAxis);
+
+	m_cineRate = new QSpinBox(cineGroup);
+	m_cineRate->setRange(CINE_FPS_MIN, CINE_FPS_MAX);
+	m_cineRate->setValue(CINE_FPS_DEFAULT);
+	m_cineRate->setSuffix(QStringLiteral(" fps"));
+
+	m_cinePrefetch = new QSpinBox(cineGroup);
+	m_cinePrefetch->setRange(0, CINE_PREFETCH_MAX);
+	m_cinePrefetch->setValue(CINE_PREFETCH_DEFAULT);
+	m_cinePrefetch->setToolTip(QStringLiteral("Slices drawn ahead of the current slice, 0 disables prefetching"));
+
+	m_cinePlay = new QPushButton(QStringLiteral("Play"), cineGroup);
+	m_cinePlay->setCheckable(true);
+
+	m_cineStats = new QLabel(cineGroup);
+
+	QFormLayout* cineLayout = new QFormLayout(cineGroup);
+	cineLayout->addRow(QStringLiteral("Axis"), m_cineAxis);
+	cineLayout->addRow(QStringLiteral("Rate"), m_cineRate);
+	cineLayout->addRow(QStringLiteral("Prefetch"), m_cinePrefetch);
+	cineLayout->addRow(m_cinePlay);
+	cineLayout->addRow(m_cineStats);
 
 	//2D sampler functions
 	QGroupBox* samplerGroup2D = new QGroupBox(QStringLiteral("2D Sampler Function:"), this);
@@ -206,6 +793,19 @@ QWidget* MainWindow::createControlArea()
 	samplerGroup3D->layout()->addWidget(m_samplerBasic3D);
 	samplerGroup3D->layout()->addWidget(m_samplerTrilinear);
 
+	//Isotropic resampling, only useful for volumes with a voxel scale factor
+	m_isotropicToggle = new QCheckBox(QStringLiteral("Resample to Isotropic Voxels"), samplerGroup3D);
+	m_isotropicToggle->setEnabled(!VolumeResampler::isIsotropic(*m_render.volume()));
+	m_isotropicToggle->setToolTip(QStringLiteral("Resample thick slices once in the background, so cheaper samplers give the same quality"));
+
+	m_isotropicKernel = new QComboBox(samplerGroup3D);
+	m_isotropicKernel->addItems({ QStringLiteral("Nearest"), QStringLiteral("Linear"), QStringLiteral("Cubic") });
+	m_isotropicKernel->setCurrentIndex(m_render.resampleKernel());
+	m_isotropicKernel->setEnabled(m_isotropicToggle->isEnabled());
+
+	samplerGroup3D->layout()->addWidget(m_isotropicToggle);
+	samplerGroup3D->layout()->addWidget(m_isotropicKernel);
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////
 
 	QVBoxLayout* ctrlLayout = new QVBoxLayout(this);
@@ -223,7 +823,27 @@ QWidget* MainWindow::createControlArea()
 	ctrlLayout->addWidget(new QSplitter(this));
 	ctrlLayout->addWidget(m_mipToggle);
 	ctrlLayout->addWidget(m_heToggle);
+	ctrlLayout->addWidget(m_aheToggle);
+	ctrlLayout->addWidget(m_statsToggle);
+	ctrlLayout->addLayout(traceLayout);
+	ctrlLayout->addWidget(new QSplitter(this));
+	ctrlLayout->addWidget(cineGroup);
 	ctrlLayout->addWidget(new QSplitter(this));
+
+	ctrlLayout->addWidget(createClipControls());
+	ctrlLayout->addWidget(new QSplitter(this));
+
+	ctrlLayout->addWidget(createFilterControls());
+	ctrlLayout->addWidget(new QSplitter(this));
+
+	ctrlLayout->addWidget(createSegmentControls());
+	ctrlLayout->addWidget(new QSplitter(this));
+
+	if (m_series != nullptr)
+	{
+		ctrlLayout->addWidget(createSeriesControls());
+		ctrlLayout->addWidget(new QSplitter(this));
+	}
 	ctrlLayout->addWidget(samplerGroup2D);
 	ctrlLayout->addWidget(new QSplitter(this));
 
@@ -12,10 +12,18 @@
 class QLabel;
 class QCheckBox;
 class QRadioButton;
+class QPushButton;
+class QComboBox;
+class QSpinBox;
+class QDoubleSpinBox;
 class LabelledSlider;
 class SubimageView;
 class CameraView;
+class ObliqueView;
+class StatisticsPanel;
 class GLVolumeScene;
+class CinePlayer;
+class VolumeSeries;
 
 class MainWindow : public QMainWindow
 {
@@ -24,9 +32,14 @@ class MainWindow : public QMainWindow
 
 public:
 	
-    explicit MainWindow(Volume& volume, QWidget *parent = 0);
+    explicit MainWindow(Volume& volume, VolumeSeries* series = nullptr, QWidget *parent = 0);
     ~MainWindow();
 
+	/*
+		Renderer used by the views
+	*/
+	VolumeRender* render() { return &m_render; }
+
 private slots:
 
 	/*
@@ -34,12 +47,78 @@ private slots:
 	*/
 	void scaleImages(int value);
 
+	/*
+		Write recorded trace events to a file chosen by the user
+	*/
+	void saveTrace();
+
+	/*
+		Start or stop cine playback of the chosen axis
+	*/
+	void playCine(bool play);
+
+	/*
+		Show the frame of the cine axis chosen by the player
+	*/
+	void showCineFrame(int frame);
+
+	/*
+		Apply the region of interest chosen by the clip controls
+	*/
+	void updateClipRegion();
+
+	/*
+		Reset the region of interest to the whole volume
+	*/
+	void resetClipRegion();
+
+	/*
+		Show the mean and standard deviation of the voxels in the region of interest box
+	*/
+	void measureClipBox();
+
+	/*
+		Segment the region containing the voxel where the current slices meet
+	*/
+	void growRegion();
+
+	/*
+		Replace the volume with the unfiltered volume passed through the chosen filter
+	*/
+	void applyFilter();
+
+	/*
+		Save the volume as shown, including any filter, as a dataset and config file
+	*/
+	void saveVolume();
+
+	/*
+		Start or stop playback of the time series
+	*/
+	void playSeries(bool play);
+
+	/*
+		Show a frame of the time series
+	*/
+	void showTimePoint(int index);
+
 private:
 
+	//Slider and view of an axis
+	LabelledSlider* axisSlider(VolumeAxis axis) const;
+	SubimageView* axisSubimage(VolumeAxis axis) const;
+
 	//Create gui widgets
 	QWidget* createWidgets();
 	QWidget* createControlArea();
 	QWidget* createImageArea();
+	QWidget* createSeriesControls();
+	QWidget* createClipControls();
+	QWidget* createSegmentControls();
+	QWidget* createFilterControls();
+
+	//Pass a frame through the chosen filter
+	Volume filterFrame(const Volume& frame);
 
 	//Volume viewer
 	VolumeRender m_render;
@@ -58,8 +137,24 @@ private:
 
 	//histogram equalization toggle
 	QCheckBox* m_heToggle;
+	//adaptive histogram equalization toggle
+	QCheckBox* m_aheToggle;
 	//mip toggle
 	QCheckBox* m_mipToggle;
+	//render statistics overlay toggle
+	QCheckBox* m_statsToggle;
+
+	//Tracing controls
+	QCheckBox* m_traceToggle;
+	QPushButton* m_traceSave;
+
+	//Cine playback controls
+	CinePlayer* m_cine;
+	QComboBox* m_cineAxis;
+	QSpinBox* m_cineRate;
+	QSpinBox* m_cinePrefetch;
+	QPushButton* m_cinePlay;
+	QLabel* m_cineStats;
 
 	//2D sampler options
 	QRadioButton* m_samplerBasic;
@@ -74,6 +169,52 @@ private:
 	QRadioButton* m_samplerBasic3D;
 	QRadioButton* m_samplerTrilinear;
 
+	//Isotropic resampling
+	QCheckBox* m_isotropicToggle;
+	QComboBox* m_isotropicKernel;
+
+	//Oblique slice
+	ObliqueView* m_obliqueView;
+
+	//Slice statistics
+	StatisticsPanel* m_statisticsPanel;
+
+	//Region of interest controls, box bounds as percentages of each axis
+	QSpinBox* m_clipMin[3];
+	QSpinBox* m_clipMax[3];
+	QCheckBox* m_clipOblique;
+	QPushButton* m_clipReset;
+	QLabel* m_clipMeasure;
+
+	//Segmentation controls, intensity range and connectivity of the grown region
+	QSpinBox* m_segmentLower;
+	QSpinBox* m_segmentUpper;
+	QComboBox* m_segmentConnectivity;
+	QPushButton* m_segmentGrow;
+	QPushButton* m_segmentClear;
+	QLabel* m_segmentInfo;
+
+	//Filter controls, the size is the standard deviation of the Gaussian filter and the radius of the box filter
+	QComboBox* m_filterType;
+	QDoubleSpinBox* m_filterSize;
+	QPushButton* m_filterApply;
+	QPushButton* m_filterSave;
+	QLabel* m_filterInfo;
+
+	//Time series, if the volume is one frame of a series
+	VolumeSeries* m_series;
+	int m_timePoint = 0;
+
+	//Volume or current frame before filtering, shares its voxels with the renderer while no filter is chosen
+	Volume m_unfiltered;
+
+	//Time series playback controls
+	CinePlayer* m_timePlayer = nullptr;
+	LabelledSlider* m_timeSlider = nullptr;
+	QSpinBox* m_timeRate = nullptr;
+	QPushButton* m_timePlay = nullptr;
+	QLabel* m_timeStats = nullptr;
+
 	//OpenGL based volume renderer
 	GLVolumeScene* m_glView;
 };
@@ -0,0 +1,119 @@
+/*
+	Oblique View widget
+*/
+
+#include "ObliqueView.h"
+
+#include <QMouseEvent>
+#include <QWheelEvent>
+
+enum Constants
+{
+	//Degrees of rotation per pixel dragged
+	DRAG_DEGREES_PER_PIXEL = 1,
+	//Wheel steps to move the plane through the whole volume
+	WHEEL_STEPS_PER_VOLUME = 256
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObliqueView::ObliqueView(VolumeRender* render, QWidget* parent) :
+	m_render(render),
+	m_width(300),
+	m_height(300),
+	m_dirty(this, [this](quint32) { redraw(); }, InputsOblique | InputPlane),
+	ImageView(parent)
+{
+	Q_ASSERT(m_render != nullptr);
+
+	//Setup image widget
+	ImageView::setSource(&m_buffers);
+	QWidget::setFixedSize(m_width, m_height);
+
+	//Redraw when render state used by oblique slices changes
+	connect(m_render, &VolumeRender::inputsChanged, this, &ObliqueView::invalidate);
+
+	invalidate(DirtyState::AllInputs);
+}
+
+void ObliqueView::setSlice(const ObliqueSlice& slice)
+{
+	if (slice == m_slice)
+		return;
+
+	m_slice = slice;
+	invalidate(InputPlane);
+
+	emit sliceChanged(m_slice);
+}
+
+void ObliqueView::resetSlice()
+{
+	setSlice(ObliqueSlice());
+}
+
+void ObliqueView::invalidate(quint32 inputs)
+{
+	m_dirty.invalidate(inputs);
+}
+
+/*
+	Redraw event
+*/
+void ObliqueView::redraw()
+{
+	//Prepare buffer
+	ImageBuffer& buffer = m_buffers.back().realloc(m_width, m_height, ImageBuffer::Gray8);
+
+	//Render plane
+	const RenderStats stats = m_render->drawOblique(buffer, m_slice);
+	ImageView::setStatistics(stats, m_render->statistics(RenderOblique));
+
+	//Present view
+	m_buffers.swap();
+	ImageView::present();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*
+	Input events
+*/
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ObliqueView::mousePressEvent(QMouseEvent* event)
+{
+	m_lastPoint = event->localPos();
+}
+
+void ObliqueView::mouseMoveEvent(QMouseEvent* event)
+{
+	if (event->buttons() & Qt::LeftButton)
+	{
+		const QPointF delta = event->localPos() - m_lastPoint;
+		m_lastPoint = event->localPos();
+
+		//Horizontal motion tilts the plane about its v axis, vertical motion about its u axis
+		const QQuaternion yaw = QQuaternion::fromAxisAndAngle(m_slice.vAxis().normalized(), (float)delta.x() * DRAG_DEGREES_PER_PIXEL);
+		const QQuaternion pitch = QQuaternion::fromAxisAndAngle(m_slice.uAxis().normalized(), (float)-delta.y() * DRAG_DEGREES_PER_PIXEL);
+
+		//Mouse moves within one turn of the event loop are drawn together
+		setSlice(m_slice.rotated(yaw * pitch));
+	}
+}
+
+void ObliqueView::mouseDoubleClickEvent(QMouseEvent* event)
+{
+	Q_UNUSED(event);
+	resetSlice();
+}
+
+void ObliqueView::wheelEvent(QWheelEvent* event)
+{
+	//One notch of a standard wheel is 120 units
+	const float steps = (float)event->angleDelta().y() / 120.0f;
+
+	setSlice(m_slice.translated(steps / WHEEL_STEPS_PER_VOLUME));
+	event->accept();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,91 @@
+/*
+	Oblique View widget
+
+	Represents an oblique slice through a Volume.
+	The plane is rotated about its centre by dragging with the left mouse button,
+	moved along its normal with the mouse wheel, and reset by double clicking.
+*/
+
+#pragma once
+
+#include "gfx/VolumeRender.h"
+#include "gfx/ObliqueSlice.h"
+#include "util/DirtyState.h"
+#include "ImageView.h"
+
+class ObliqueView : public ImageView
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(ObliqueView)
+
+public:
+
+	/*
+		Construct an oblique view widget
+	*/
+	explicit ObliqueView(VolumeRender* render, QWidget* parent = nullptr);
+
+	/*
+		Plane being shown
+	*/
+	const ObliqueSlice& slice() const { return m_slice; }
+
+public slots:
+
+	/*
+		Set the plane being shown
+	*/
+	void setSlice(const ObliqueSlice& slice);
+
+	/*
+		Show the z axis slice through the middle of the volume
+	*/
+	void resetSlice();
+
+	/*
+		Mark render inputs as changed, the view is redrawn once on the next turn of the event loop
+		if it depends on any of them
+	*/
+	void invalidate(quint32 inputs);
+
+	/*
+		Redraw view immediately
+	*/
+	void redraw();
+
+signals:
+
+	/*
+		Emitted when the plane being shown changes
+	*/
+	void sliceChanged(const ObliqueSlice& slice);
+
+private:
+
+	//View state inputs, following the RenderInput flags
+	enum ViewInput
+	{
+		InputPlane = 1 << 16
+	};
+
+	//Input event handlers
+	void mousePressEvent(QMouseEvent* event) override;
+	void mouseMoveEvent(QMouseEvent* event) override;
+	void mouseDoubleClickEvent(QMouseEvent* event) override;
+	void wheelEvent(QWheelEvent* event) override;
+
+	QPointF m_lastPoint;
+
+	ObliqueSlice m_slice;
+
+	//View dimensions
+	quint32 m_width;
+	quint32 m_height;
+
+	ImageSwapChain m_buffers;
+
+	//Changed inputs since the last redraw
+	DirtyState m_dirty;
+
+	VolumeRender* m_render;
+};
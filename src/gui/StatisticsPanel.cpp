@@ -0,0 +1,181 @@
+/*
+	Statistics Panel widget source
+*/
+
+#include <QtWidgets>
+
+#include "StatisticsPanel.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*
+	Histogram bar chart
+*/
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HistogramView : public QWidget
+{
+public:
+
+	explicit HistogramView(QWidget* parent = nullptr) :
+		QWidget(parent)
+	{
+		QWidget::setMinimumHeight(100);
+	}
+
+	/*
+		Set the bin counts to show
+	*/
+	void setCounts(const quint32* counts)
+	{
+		m_counts.clear();
+
+		if (counts != nullptr)
+		{
+			m_counts = QVector<quint32>(VolumeStatistics::Bins);
+			std::copy(counts, counts + VolumeStatistics::Bins, m_counts.begin());
+		}
+
+		QWidget::update();
+	}
+
+protected:
+
+	void paintEvent(QPaintEvent*) override
+	{
+		QPainter painter(this);
+		painter.fillRect(rect(), Qt::black);
+
+		if (m_counts.isEmpty())
+			return;
+
+		//Bins are scaled logarithmically so the background peak does not hide the tissue
+		float peak = 0.0f;
+
+		for (quint32 count : m_counts)
+		{
+			peak = std::max(peak, log1pf((float)count));
+		}
+
+		if (peak <= 0.0f)
+			return;
+
+		const float barWidth = (float)width() / m_counts.size();
+
+		for (int bin = 0; bin < m_counts.size(); bin++)
+		{
+			const float h = (log1pf((float)m_counts[bin]) / peak) * height();
+			painter.fillRect(QRectF(bin * barWidth, height() - h, std::max(barWidth, 1.0f), h), Qt::lightGray);
+		}
+	}
+
+private:
+
+	QVector<quint32> m_counts;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+StatisticsPanel::StatisticsPanel(VolumeRender* render, QWidget* parent) :
+	QWidget(parent),
+	m_render(render)
+{
+	Q_ASSERT(m_render != nullptr);
+
+	QGridLayout* table = new QGridLayout();
+
+	const QString columns[] = { QStringLiteral("Min"), QStringLiteral("Max"), QStringLiteral("Mean"), QStringLiteral("Std Dev") };
+	const QString rows[] = { QStringLiteral("X slice"), QStringLiteral("Y slice"), QStringLiteral("Z slice"), QStringLiteral("Volume") };
+
+	for (int c = 0; c < 4; c++)
+	{
+		table->addWidget(new QLabel(columns[c], this), 0, c + 1, Qt::AlignRight);
+	}
+
+	for (int r = 0; r < 4; r++)
+	{
+		table->addWidget(new QLabel(rows[r], this), r + 1, 0);
+
+		for (int c = 0; c < 4; c++)
+		{
+			m_rows[r][c] = new QLabel(this);
+			m_rows[r][c]->setAlignment(Qt::AlignRight);
+			table->addWidget(m_rows[r][c], r + 1, c + 1);
+		}
+	}
+
+	m_histogramAxis = new QComboBox(this);
+	m_histogramAxis->addItems({ QStringLiteral("X slice"), QStringLiteral("Y slice"), QStringLiteral("Z slice") });
+	m_histogramAxis->setCurrentIndex(ZAxis);
+
+	m_histogram = new HistogramView(this);
+
+	QFormLayout* histogramLayout = new QFormLayout();
+	histogramLayout->addRow(QStringLiteral("Histogram"), m_histogramAxis);
+
+	QVBoxLayout* layout = new QVBoxLayout(this);
+	layout->addLayout(table);
+	layout->addLayout(histogramLayout);
+	layout->addWidget(m_histogram);
+	layout->addStretch();
+
+	connect(m_histogramAxis, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &StatisticsPanel::refresh);
+
+	//Statistics are requested again when the volume is replaced, and shown once built
+	//Volumes replaced during a build, such as frames of a playing series, are requested when it finishes
+	connect(m_render, &VolumeRender::inputsChanged, this, [this](quint32 inputs) {
+		if (inputs & InputVolume)
+			refresh();
+	});
+
+	connect(m_render, &VolumeRender::statisticsReady, this, &StatisticsPanel::refresh);
+}
+
+void StatisticsPanel::setSlice(VolumeAxis axis, Volume::IndexType index)
+{
+	if (m_index[axis] == index)
+		return;
+
+	m_index[axis] = index;
+	refresh();
+}
+
+void StatisticsPanel::showEvent(QShowEvent* event)
+{
+	QWidget::showEvent(event);
+	refresh();
+}
+
+void StatisticsPanel::refresh()
+{
+	//Statistics are only computed once the panel is shown
+	if (!isVisible())
+		return;
+
+	const std::shared_ptr<const VolumeStatistics> statistics = m_render->volumeStatistics();
+
+	//Nothing to show until the first build finishes
+	if (!statistics)
+		return;
+
+	const VolumeStatistics& stats = *statistics;
+
+	auto showRow = [this](int row, const VolumeStatistics::Summary& summary) {
+		m_rows[row][0]->setText(QString::number(summary.min));
+		m_rows[row][1]->setText(QString::number(summary.max));
+		m_rows[row][2]->setText(QString::number(summary.mean(), 'f', 1));
+		m_rows[row][3]->setText(QString::number(summary.stddev(), 'f', 1));
+	};
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const Volume::IndexType index = std::min(m_index[axis], stats.slices((VolumeAxis)axis) - 1);
+		showRow(axis, stats.slice((VolumeAxis)axis, index));
+	}
+
+	showRow(3, stats.total());
+
+	const VolumeAxis axis = (VolumeAxis)m_histogramAxis->currentIndex();
+	m_histogram->setCounts(stats.histogram(axis, std::min(m_index[axis], stats.slices(axis) - 1)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
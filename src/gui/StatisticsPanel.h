@@ -0,0 +1,59 @@
+/*
+	Statistics Panel widget
+
+	Shows the minimum, maximum, mean and standard deviation of the current slice of each axis and of the whole volume,
+	along with the histogram of the current slice of a chosen axis.
+
+	Statistics are computed once per volume by the renderer in the background, requested only while the panel is shown,
+	so following the slice sliders costs nothing and replacing the volume does not block the GUI thread.
+*/
+
+#pragma once
+
+#include <QWidget>
+
+#include "gfx/VolumeRender.h"
+
+class QLabel;
+class QComboBox;
+class HistogramView;
+
+class StatisticsPanel : public QWidget
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(StatisticsPanel)
+
+public:
+
+	/*
+		Construct a statistics panel for the volume of a renderer
+	*/
+	explicit StatisticsPanel(VolumeRender* render, QWidget* parent = nullptr);
+
+public slots:
+
+	/*
+		Set the current slice of an axis
+	*/
+	void setSlice(VolumeAxis axis, Volume::IndexType index);
+
+	/*
+		Update the statistics shown
+	*/
+	void refresh();
+
+private:
+
+	void showEvent(QShowEvent* event) override;
+
+	VolumeRender* m_render;
+
+	//Current slice of each axis
+	Volume::IndexType m_index[3] = { 0, 0, 0 };
+
+	//Rows of statistics, one per axis followed by the whole volume
+	QLabel* m_rows[4][4];
+
+	QComboBox* m_histogramAxis;
+	HistogramView* m_histogram;
+};
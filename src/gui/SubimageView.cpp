@@ -4,6 +4,15 @@
 
 #include "SubimageView.h"
 #include "ThumbnailDialog.h"
+#include "ThumbnailCache.h"
+
+enum Constants
+{
+	//Time without changes after which a held control is considered settled
+	SETTLE_TIME_MS = 150,
+	//Largest dimension of a preview image
+	PREVIEW_SIZE_MAX = 256
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -11,6 +20,8 @@ SubimageView::SubimageView(VolumeRender* render, VolumeAxis axis, Volume::IndexT
 	m_render(render),
 	m_axis(axis),
 	m_index(index),
+	m_dirty(this, [this](quint32) { redraw(); }),
+	m_prefetcher(render, axis, &m_slices),
 	QWidget(parent)
 {
 	Q_ASSERT(m_render != nullptr);
@@ -20,7 +31,8 @@ SubimageView::SubimageView(VolumeRender* render, VolumeAxis axis, Volume::IndexT
 	m_layout.addWidget(&m_imageLabel);
 	QWidget::setLayout(&m_layout);
 
-	m_image.setAlignment(Qt::AlignCenter);
+	m_image.setSource(&m_buffers);
+	m_image.setValidRegion(m_valid);
 	m_imageLabel.setAlignment(Qt::AlignTop | Qt::AlignHCenter);
 
 	//Figure out scaled width/height for given axis
@@ -48,7 +60,101 @@ SubimageView::SubimageView(VolumeRender* render, VolumeAxis axis, Volume::IndexT
 
 	m_text = labels[m_axis];
 
-	redraw();
+	m_thumbnails = new ThumbnailCache(m_render, m_axis, this);
+
+	//Redraw when render state used by subimages changes
+	connect(m_render, &VolumeRender::inputsChanged, this, &SubimageView::invalidate);
+
+	//Prefetched slices are stale once the render state changes
+	connect(m_render, &VolumeRender::redraw2D, this, [this]() {
+		m_prefetcher.cancel();
+		m_slices.clear();
+	});
+
+	//Draw parts of the image as they are scrolled into view
+	connect(&m_image, &ImageView::exposed, this, &SubimageView::fill);
+
+	//Draw at full quality once a held control stops moving
+	m_settle.setSingleShot(true);
+	m_settle.setInterval(SETTLE_TIME_MS);
+	connect(&m_settle, &QTimer::timeout, [this]() { invalidate(InputQuality); });
+
+	updateDependencies();
+	invalidate(DirtyState::AllInputs);
+}
+
+void SubimageView::setScale(float scale)
+{
+	if (scale == m_scaleFactor)
+		return;
+
+	m_scaleFactor = scale;
+	interacted();
+	invalidate(InputScale);
+}
+
+void SubimageView::setIndex(Volume::IndexType idx)
+{
+	if (idx == m_index)
+		return;
+
+	m_direction = (idx > m_index) ? 1 : -1;
+	m_stepped = true;
+	m_index = idx;
+	interacted();
+	invalidate(InputIndex);
+}
+
+void SubimageView::setInteracting(bool interacting)
+{
+	if (interacting == m_interacting)
+		return;
+
+	m_interacting = interacting;
+
+	//Replace the preview as soon as the control is released
+	if (!interacting)
+	{
+		m_settle.stop();
+
+		if (m_previewShown)
+			invalidate(InputQuality);
+	}
+}
+
+void SubimageView::interacted()
+{
+	if (m_interacting)
+		m_settle.start();
+}
+
+void SubimageView::useMIP(bool use)
+{
+	if (use == m_useMip)
+		return;
+
+	m_useMip = use;
+	updateDependencies();
+	invalidate(InputMode);
+}
+
+void SubimageView::invalidate(quint32 inputs)
+{
+	m_dirty.invalidate(inputs);
+}
+
+void SubimageView::updateDependencies()
+{
+	quint32 dependencies = Inputs2D | InputsView;
+
+	//Projections are the same for every index, but only cover the region of interest
+	if (m_useMip)
+	{
+		dependencies &= ~InputIndex;
+		dependencies |= InputClip;
+	}
+
+	m_dirty.setDependencies(dependencies);
 }
 
 void SubimageView::redraw()
@@ -56,24 +162,127 @@ void SubimageView::redraw()
 	//Reserve space in buffer
 	const Volume::SizeType w = m_scaleFactor * m_scaledWidth;
 	const Volume::SizeType h = m_scaleFactor * m_scaledHeight;
-	m_buffer.realloc(w, h);
+	//Previews while a control is moving, unless the slice is prefetched
+	if (m_settle.isActive() && (m_useMip || !m_slices.contains(m_index, w, h)))
+	{
+		drawPreview(w, h);
+		return;
+	}
 
-	//If using maximum intensity projection
-	//Render view
-	if (m_useMip)
+	ImageBuffer& buffer = m_buffers.back().realloc(w, h, ImageBuffer::Gray8);
+
+	QRect region;
+
+	//Present a prefetched slice if there is one
+	if (!m_useMip && m_slices.fetch(m_index, buffer))
 	{
-		m_render->drawSubimageMIP(m_buffer, m_axis);
+		region = QRect(0, 0, (int)w, (int)h);
+		m_prefetchHits++;
 	}
 	else
 	{
-		m_render->drawSubimage(m_buffer, m_index, m_axis);
+		//Only the visible part of the image is drawn, the rest is drawn when scrolled into view
+		region = expand(m_image.visibleImageRect(), buffer);
+		draw(buffer, region);
+
+		//Slice was reached before it was prefetched
+		if (!m_useMip && m_stepped && m_prefetcher.count() > 0)
+			m_prefetchMisses++;
 	}
 
+	m_stepped = false;
+
 	//Present view
-	m_image.setPixmap(m_buffer.toPixmap());
+	m_buffers.swap();
+	m_valid = QRegion(region);
+	m_previewShown = false;
+	m_image.setDisplaySize(QSize());
+	m_image.setValidRegion(m_valid);
+	m_image.present();
 
 	//Update size label
 	m_imageLabel.setText(m_text + QString::number(w) + "x" + QString::number(h));
+
+	//Draw the next slices while the user looks at this one
+	if (!m_useMip)
+		m_prefetcher.prefetch(m_index, m_direction, w, h);
+	else
+		m_prefetcher.cancel();
+}
+
+void SubimageView::drawPreview(Volume::SizeType width, Volume::SizeType height)
+{
+	//Reduce resolution by a whole factor, at least halving it
+	const Volume::SizeType factor = std::max((std::max(width, height) + PREVIEW_SIZE_MAX - 1) / PREVIEW_SIZE_MAX, 2u);
+
+	ImageBuffer& buffer = m_buffers.back().realloc(std::max(width / factor, 1u), std::max(height / factor, 1u), ImageBuffer::Gray8);
+
+	if (m_useMip)
+	{
+		const RenderStats stats = m_render->drawSubimageMIP(buffer, m_axis, PriorityInteractive, QRect(), QualityPreview);
+		m_image.setStatistics(stats, m_render->statistics(RenderSubimageMIP));
+	}
+	else
+	{
+		const RenderStats stats = m_render->drawSubimage(buffer, m_index, m_axis, PriorityInteractive, QRect(), QualityPreview);
+		m_image.setStatistics(stats, m_render->statistics(RenderSubimage));
+	}
+
+	//Present the whole preview scaled up to the size of the full image
+	m_buffers.swap();
+	m_valid = QRegion();
+	m_previewShown = true;
+	m_image.setDisplaySize(QSize((int)width, (int)height));
+	m_image.setWholeImageValid();
+	m_image.present();
+
+	m_imageLabel.setText(m_text + QString::number(width) + "x" + QString::number(height) + " (preview)");
+
+	//Prefetching would compete with the previews
+	m_prefetcher.cancel();
+}
+
+void SubimageView::fill(const QRect& rect)
+{
+	ImageBuffer& buffer = m_buffers.front();
+
+	//Parts of the exposed area which are not drawn yet
+	const QRegion missing = QRegion(expand(rect, buffer)) - m_valid;
+
+	for (const QRect& region : missing.rects())
+	{
+		draw(buffer, region);
+	}
+
+	m_valid += missing;
+	m_image.setValidRegion(m_valid);
+}
+
+void SubimageView::draw(ImageBuffer& target, const QRect& region)
+{
+	if (region.isEmpty())
+		return;
+
+	//If using maximum intensity projection
+	//Render view
+	if (m_useMip)
+	{
+		const RenderStats stats = m_render->drawSubimageMIP(target, m_axis, PriorityInteractive, region);
+		m_image.setStatistics(stats, m_render->statistics(RenderSubimageMIP));
+	}
+	else
+	{
+		const RenderStats stats = m_render->drawSubimage(target, m_index, m_axis, PriorityInteractive, region);
+		m_image.setStatistics(stats, m_render->statistics(RenderSubimage));
+	}
+}
+
+QRect SubimageView::expand(const QRect& rect, const ImageBuffer& target) const
+{
+	//Margin drawn around the visible area so small scrolls are already drawn
+	const int margin = 32;
+
+	return rect.adjusted(-margin, -margin, margin, margin) & QRect(0, 0, (int)target.width(), (int)target.height());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -81,7 +290,7 @@ void SubimageView::redraw()
 void SubimageView::mousePressEvent(QMouseEvent* event)
 {
 	//When image is clicked bring up the window
-	ThumbnailDialog* dialog = new ThumbnailDialog(m_render, m_axis, this);
+	ThumbnailDialog* dialog = new ThumbnailDialog(m_thumbnails, this);
 	dialog->setAttribute(Qt::WA_DeleteOnClose);
 	dialog->show();
 }
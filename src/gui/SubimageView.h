@@ -6,8 +6,15 @@
 
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QTimer>
 
 #include "gfx/VolumeRender.h"
+#include "gfx/SliceCache.h"
+#include "gfx/SlicePrefetcher.h"
+#include "util/DirtyState.h"
+#include "ImageView.h"
+
+class ThumbnailCache;
 
 class SubimageView : public QWidget
 {
@@ -32,24 +39,90 @@ public:
 	bool usesMIP() const { return m_useMip; }
 
 	//Reset scale
-	void unsetScale() { m_scaleFactor = 1.0f; }
+	void unsetScale() { setScale(1.0f); }
+
+	/*
+		Axis the subimages are taken from
+	*/
+	VolumeAxis axis() const { return m_axis; }
+
+	/*
+		Number of slices drawn ahead of time in the direction the index is moving, 0 disables prefetching
+	*/
+	int prefetchCount() const { return m_prefetcher.count(); }
+	void setPrefetchCount(int count) { m_prefetcher.setCount(count); }
+
+	/*
+		Slices presented from the prefetched slices, and slices which had to be drawn because they were not prefetched in time
+	*/
+	quint64 prefetchHits() const { return m_prefetchHits; }
+	quint64 prefetchMisses() const { return m_prefetchMisses; }
+	void resetPrefetchStatistics() { m_prefetchHits = 0; m_prefetchMisses = 0; }
 
 public slots:
 
 	/*
 		Set properties
 	*/
-	void setScale(float scale) { m_scaleFactor = scale; redraw(); }
-	void setIndex(Volume::IndexType idx) { m_index = idx; redraw(); }
-	void useMIP(bool use) { m_useMip = use; redraw(); }
+	void setScale(float scale);
+	void setIndex(Volume::IndexType idx);
+	void useMIP(bool use);
+
+	//Show/hide render statistics over the image
+	void showStatistics(bool show) { m_image.setStatisticsVisible(show); }
+
+	/*
+		Set while a control driving the view is held, such as a slider being dragged.
+
+		Changes made while interacting are drawn as previews at reduced resolution with the cheapest sampler,
+		followed by a full quality image once the control settles or is released.
+	*/
+	void setInteracting(bool interacting);
+
+	/*
+		Mark render inputs as changed, the subimage is redrawn once on the next turn of the event loop
+		if it depends on any of them
+	*/
+	void invalidate(quint32 inputs);
 
 	/*
-		Redraw subimage
+		Redraw subimage immediately
 	*/
 	void redraw();
 	
 private:
 
+	/*
+		View state inputs, following the RenderInput flags
+	*/
+	enum ViewInput
+	{
+		InputIndex = 1 << 16,
+		InputScale = 1 << 17,
+		InputMode  = 1 << 18,
+		InputQuality = 1 << 19,
+
+		InputsView = InputIndex | InputScale | InputMode | InputQuality
+	};
+
+	//Draw a preview of the whole image at reduced resolution
+	void drawPreview(Volume::SizeType width, Volume::SizeType height);
+
+	//Called on changes made while interacting
+	void interacted();
+
+	//Update render inputs the view depends on
+	void updateDependencies();
+
+	//Draw parts of a region of the current image which have not been drawn yet
+	void fill(const QRect& rect);
+
+	//Draw a region of an image with the current view state
+	void draw(ImageBuffer& target, const QRect& region);
+
+	//Region of the image to draw for a visible rectangle
+	QRect expand(const QRect& rect, const ImageBuffer& target) const;
+
 	//Input events
 	void mousePressEvent(QMouseEvent* event) override;
 
@@ -61,9 +134,37 @@ private:
 	Volume::SizeType m_scaledWidth = 0;
 	Volume::SizeType m_scaledHeight = 0;
 
-	ImageBuffer m_buffer;
+	ImageSwapChain m_buffers;
+
+	//Changed inputs since the last redraw
+	DirtyState m_dirty;
+
+	//A control driving the view is held
+	bool m_interacting = false;
+	//Running while the control keeps moving, previews are drawn until it times out
+	QTimer m_settle;
+	//The image presented is a preview
+	bool m_previewShown = false;
+
+	//Parts of the front buffer which are drawn, only the visible part of the image is drawn
+	QRegion m_valid;
+
+	//Slices drawn ahead of time
+	SliceCache m_slices;
+	SlicePrefetcher m_prefetcher;
+
+	//Sign of the last index change
+	int m_direction = 0;
+	//Index changed since the last redraw
+	bool m_stepped = false;
+
+	quint64 m_prefetchHits = 0;
+	quint64 m_prefetchMisses = 0;
+
+	//Thumbnails of this axis, kept between dialog openings
+	ThumbnailCache* m_thumbnails;
 
-	QLabel m_image;
+	ImageView m_image;
 	QLabel m_imageLabel;
 	QVBoxLayout m_layout;
 
@@ -0,0 +1,36 @@
+/*
+	Thumbnail cache source
+*/
+
+#include "ThumbnailCache.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThumbnailCache::ThumbnailCache(VolumeRender* render, VolumeAxis axis, QObject* parent) :
+	QObject(parent),
+	m_render(render),
+	m_axis(axis)
+{
+	Q_ASSERT(render != nullptr);
+
+	//Thumbnails are invalid once the render state changes
+	connect(m_render, &VolumeRender::redraw2D, this, &ThumbnailCache::clear);
+}
+
+void ThumbnailCache::insert(Volume::IndexType index, const QPixmap& thumbnail, quint32 generation)
+{
+	if (generation == m_generation)
+	{
+		m_thumbnails.insert(index, thumbnail);
+	}
+}
+
+void ThumbnailCache::clear()
+{
+	m_thumbnails.clear();
+	m_generation++;
+
+	emit cleared();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,70 @@
+/*
+	Thumbnail cache
+
+	Stores rendered thumbnails of the subimages of an axis so they persist between thumbnail dialog openings.
+	The cache is emptied whenever the renderer is changed.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPixmap>
+
+#include "gfx/VolumeRender.h"
+
+class ThumbnailCache : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(ThumbnailCache)
+
+public:
+
+	/*
+		Construct an empty thumbnail cache for an axis of a renderer
+	*/
+	explicit ThumbnailCache(VolumeRender* render, VolumeAxis axis, QObject* parent = nullptr);
+
+	/*
+		Renderer/axis the thumbnails are drawn from
+	*/
+	VolumeRender* render() const { return m_render; }
+	VolumeAxis axis() const { return m_axis; }
+
+	/*
+		Cached thumbnail lookup
+	*/
+	bool contains(Volume::IndexType index) const { return m_thumbnails.contains(index); }
+	QPixmap get(Volume::IndexType index) const { return m_thumbnails.value(index); }
+
+	/*
+		Store a thumbnail.
+
+		Thumbnails drawn before the cache was last cleared are discarded.
+	*/
+	void insert(Volume::IndexType index, const QPixmap& thumbnail, quint32 generation);
+
+	/*
+		Number of times the cache has been cleared.
+
+		Used to detect thumbnails which became stale while being drawn.
+	*/
+	quint32 generation() const { return m_generation; }
+
+public slots:
+
+	void clear();
+
+signals:
+
+	//Emitted after the cache has been emptied
+	void cleared();
+
+private:
+
+	QHash<Volume::IndexType, QPixmap> m_thumbnails;
+	quint32 m_generation = 0;
+
+	VolumeRender* m_render;
+	VolumeAxis m_axis;
+};
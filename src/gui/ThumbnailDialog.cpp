@@ -4,11 +4,14 @@
 
 #include <QVBoxLayout>
 #include <QListWidget>
+#include <QScrollBar>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+#include <QThread>
+#include <QTimer>
 
 #include "ThumbnailDialog.h"
 
-#include "gfx/VolumeSubimageRange.h"
-
 enum Constants
 {
 	THUMBNAIL_WIDTH = 128,
@@ -19,14 +22,15 @@ enum Constants
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
-ThumbnailDialog::ThumbnailDialog(VolumeRender* render, VolumeAxis axis, QWidget* parent) :
-	m_render(render),
-	m_axis(axis),
+ThumbnailDialog::ThumbnailDialog(ThumbnailCache* cache, QWidget* parent) :
+	m_cache(cache),
+	m_render(cache->render()),
+	m_axis(cache->axis()),
 	QDialog(parent)
 {
-	Q_ASSERT(render != nullptr);
+	Q_ASSERT(cache != nullptr);
 
-	VolumeSubimageRange range(render->volume(), axis);
+	const Volume::SizeType count = m_render->volume()->axisSize(m_axis);
 
 	/*
 		Setup list widget
@@ -36,27 +40,37 @@ ThumbnailDialog::ThumbnailDialog(VolumeRender* render, VolumeAxis axis, QWidget*
 	m_tbList->setViewMode(QListWidget::IconMode);
 	m_tbList->setIconSize(QSize(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT));
 	m_tbList->setResizeMode(QListWidget::Adjust);
+	m_tbList->setUniformItemSizes(true);
 	m_tbList->resize(DIALOG_WIDTH, DIALOG_HEIGHT);
 	m_tbList->setDragEnabled(false);
 
-	ImageBuffer image(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+	//Placeholder shown until a thumbnail has been drawn
+	QPixmap placeholder(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+	placeholder.fill(Qt::black);
+
+	m_items.resize((int)count);
+	m_states.fill(Pending, (int)count);
 
 	//For every subimage along axis
-	for (const VolumeSubimage& subimage : range)
+	for (Volume::IndexType index = 0; index < count; index++)
 	{
 		//Create list item with subimage information
 		QListWidgetItem* item = new QListWidgetItem(m_tbList);
 
-		//Draw slice and store result in QIcon
-		render->drawSubimage(image, subimage.index(), axis);
-		
-		QIcon icon;
-		icon.addPixmap(image.toPixmap());
+		//Use cached thumbnail if there is one
+		if (m_cache->contains(index))
+		{
+			item->setIcon(QIcon(m_cache->get(index)));
+			m_states[index] = Done;
+		}
+		else
+		{
+			item->setIcon(QIcon(placeholder));
+		}
 
-		item->setIcon(icon);
-		item->setText(QString::number(subimage.index()));
+		item->setText(QString::number(index));
 
-		m_tbList->addItem(item);
+		m_items[index] = item;
 	}
 
 	//Setup ListView widget and sizing
@@ -76,7 +90,104 @@ ThumbnailDialog::ThumbnailDialog(VolumeRender* render, VolumeAxis axis, QWidget*
 	//Connect item clicked event
 	connect(m_tbList, &QListWidget::itemClicked, this, &ThumbnailDialog::clicked);
 
-	QDialog::setWindowTitle(axisLabels[axis]);
+	//Newly visible thumbnails take priority when scrolling
+	connect(m_tbList->verticalScrollBar(), &QScrollBar::valueChanged, this, &ThumbnailDialog::schedule);
+	connect(m_tbList->horizontalScrollBar(), &QScrollBar::valueChanged, this, &ThumbnailDialog::schedule);
+
+	//Redraw everything when the render state changes
+	connect(m_cache, &ThumbnailCache::cleared, this, &ThumbnailDialog::reset);
+
+	QDialog::setWindowTitle(axisLabels[m_axis]);
+
+	//Start drawing once the dialog has been laid out
+	QTimer::singleShot(0, this, &ThumbnailDialog::schedule);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThumbnailDialog::schedule()
+{
+	const int maxDrawing = std::max(QThread::idealThreadCount(), 1);
+	const QRect viewport = m_tbList->viewport()->rect();
+
+	//Visible thumbnails first
+	for (int i = 0; i < m_items.size() && m_drawing < maxDrawing; i++)
+	{
+		if (m_states[i] == Pending && m_tbList->visualItemRect(m_items[i]).intersects(viewport))
+		{
+			start((Volume::IndexType)i);
+		}
+	}
+
+	//Off-screen thumbnails only when visible ones are done
+	for (int i = 0; i < m_items.size() && m_drawing < maxDrawing; i++)
+	{
+		if (m_states[i] == Pending)
+		{
+			start((Volume::IndexType)i);
+		}
+	}
+}
+
+void ThumbnailDialog::start(Volume::IndexType index)
+{
+	m_states[index] = Drawing;
+	m_drawing++;
+
+	VolumeRender* render = m_render;
+	const VolumeAxis axis = m_axis;
+	const quint32 generation = m_cache->generation();
+
+	//Draw slice on a worker thread
+	QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(this);
+
+	connect(watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+		finished(index, watcher->result(), generation);
+		watcher->deleteLater();
+	});
+
+	watcher->setFuture(QtConcurrent::run([=]() {
+		ImageBuffer image(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+		render->drawSubimage(image, index, axis, PriorityBackground);
+		//Detach from buffer memory before it is released
+		return image.toImage().copy();
+	}));
+}
+
+void ThumbnailDialog::finished(Volume::IndexType index, const QImage& image, quint32 generation)
+{
+	m_drawing--;
+
+	//Render state changed while drawing, thumbnail must be drawn again
+	if (generation != m_cache->generation())
+	{
+		m_states[index] = Pending;
+	}
+	else
+	{
+		const QPixmap thumbnail = QPixmap::fromImage(image);
+
+		m_items[index]->setIcon(QIcon(thumbnail));
+		m_states[index] = Done;
+
+		m_cache->insert(index, thumbnail, generation);
+	}
+
+	schedule();
+}
+
+void ThumbnailDialog::reset()
+{
+	for (int i = 0; i < m_states.size(); i++)
+	{
+		//Thumbnails being drawn are discarded on completion
+		if (m_states[i] == Done)
+		{
+			m_states[i] = Pending;
+		}
+	}
+
+	schedule();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1,5 +1,8 @@
 /*
 	Volume thumbnail dialog
+
+	Thumbnails are drawn on worker threads and filled in as they complete.
+	Visible thumbnails are drawn first, the remaining ones are drawn once every visible thumbnail is done.
 */
 
 #pragma once
@@ -7,7 +10,7 @@
 #include <QLabel>
 #include <QDialog>
 
-#include "gfx/VolumeRender.h"
+#include "ThumbnailCache.h"
 
 class QListWidget;
 class QListWidgetItem;
@@ -20,18 +23,46 @@ class ThumbnailDialog : public QDialog
 public:
 
 	/*
-		Construct a thumbnail dialog showing all the subimages of a given axis.
+		Construct a thumbnail dialog showing all the subimages of the axis of a given thumbnail cache.
 	*/
-	explicit ThumbnailDialog(VolumeRender* render, VolumeAxis axis, QWidget* parent = nullptr);
+	explicit ThumbnailDialog(ThumbnailCache* cache, QWidget* parent = nullptr);
 
 private slots:
 
 	void clicked(QListWidgetItem* item);
 
+	//Start drawing thumbnails until all worker threads are busy
+	void schedule();
+
+	//Discard all thumbnails and draw them again
+	void reset();
+
 private:
 
+	//Thumbnail drawing state
+	enum State
+	{
+		Pending,
+		Drawing,
+		Done
+	};
+
+	//Start drawing a thumbnail on a worker thread
+	void start(Volume::IndexType index);
+
+	//Thumbnail drawing completed
+	void finished(Volume::IndexType index, const QImage& image, quint32 generation);
+
 	//Thumbnail list
 	QListWidget* m_tbList;
+	QVector<QListWidgetItem*> m_items;
+	QVector<State> m_states;
+
+	//Number of thumbnails being drawn
+	int m_drawing = 0;
+
+	//Shared thumbnails
+	ThumbnailCache* m_cache;
 	//Renderer
 	VolumeRender* m_render;
 	VolumeAxis m_axis;
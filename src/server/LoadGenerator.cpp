@@ -0,0 +1,342 @@
+/*
+	Render server load generator
+
+	Opens a number of client connections to a render server and keeps a fixed number of requests
+	outstanding on each, then reports requests per second and the latency distribution.
+
+	Requests for the same view supersede each other on the server, so with more outstanding requests
+	than views some are answered as superseded. The number of distinct images asked for controls how
+	often the server's image cache is hit.
+
+	Example:
+		RenderLoad --name ct-render --clients 8 --requests 500 --inflight 4 --views 4 --type mixed
+*/
+
+#include <random>
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocalSocket>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+#include <QHash>
+
+#include "RenderProtocol.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum LoadType
+{
+	LoadSubimage,
+	LoadSubimageMIP,
+	LoadView,
+	LoadMixed
+};
+
+struct LoadOptions
+{
+	int clients = 4;
+	int requests = 500;
+	int inflight = 4;
+	int views = 4;
+	int distinct = 0;
+	LoadType type = LoadSubimage;
+	quint16 width = 256;
+	quint16 height = 256;
+};
+
+/*
+	Connection and progress of one client
+*/
+struct LoadClient
+{
+	QLocalSocket* socket = nullptr;
+	QByteArray buffer;
+
+	Volume::Dimensions dimensions;
+	std::mt19937 rng;
+
+	//Send time of outstanding requests by id
+	QHash<quint32, qint64> sent;
+
+	quint32 nextId = 0;
+	int issued = 0;
+	int completed = 0;
+};
+
+/*
+	Results gathered from all clients
+*/
+struct LoadResults
+{
+	QVector<qint64> latencies; //of successful requests, in nanoseconds
+	quint64 ok = 0;
+	quint64 superseded = 0;
+	quint64 invalid = 0;
+	quint64 bytes = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Build the next request of a client
+*/
+static RenderRequest nextRequest(LoadClient& client, const LoadOptions& options)
+{
+	RenderRequest request;
+	request.id = client.nextId++;
+	request.view = (quint16)(request.id % options.views);
+	request.width = options.width;
+	request.height = options.height;
+
+	auto random = [&](quint32 range) {
+		return std::uniform_int_distribution<quint32>(0, range - 1)(client.rng);
+	};
+
+	//Pick the image of a request type, limiting the number of distinct images when asked to
+	auto randomImage = [&](quint32 range) {
+		if (options.distinct > 0)
+			range = std::min(range, (quint32)options.distinct);
+
+		return random(range);
+	};
+
+	const LoadType type = (options.type == LoadMixed) ? (LoadType)random(3) : options.type;
+
+	switch (type)
+	{
+	case LoadSubimageMIP:
+		request.type = RequestSubimageMIP;
+		request.axis = (VolumeAxis)random(3);
+		break;
+
+	case LoadView:
+	{
+		request.type = RequestView;
+		request.camera.rotate(90, 1, 0);
+		request.camera.rotate((float)randomImage(360), 0, 0, 1);
+		request.camera.scale(1.4f);
+		break;
+	}
+
+	default:
+		request.type = RequestSubimage;
+		request.axis = ZAxis;
+		request.index = randomImage(client.dimensions.sizeZ);
+		break;
+	}
+
+	return request;
+}
+
+/*
+	Value at a percentile of sorted values
+*/
+static qint64 percentile(const QVector<qint64>& sorted, double p)
+{
+	if (sorted.isEmpty())
+		return 0;
+
+	const int i = std::min((int)(p * sorted.size()), sorted.size() - 1);
+	return sorted[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Entry point
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("RenderLoad");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Load generator for the render server");
+	parser.addHelpOption();
+
+	QCommandLineOption nameOption("name", "Local socket name of the server.", "name", "ct-render");
+	QCommandLineOption clientsOption("clients", "Number of client connections.", "count", "4");
+	QCommandLineOption requestsOption("requests", "Requests sent by each client.", "count", "500");
+	QCommandLineOption inflightOption("inflight", "Outstanding requests per client.", "count", "4");
+	QCommandLineOption viewsOption("views", "Views per client, requests cycle through them.", "count", "4");
+	QCommandLineOption distinctOption("distinct", "Limit of distinct images per request type, 0 for no limit.", "count", "0");
+	QCommandLineOption typeOption("type", "Request type (slice, mip, view or mixed).", "type", "slice");
+	QCommandLineOption sizeOption("size", "Requested image size as WxH.", "size", "256x256");
+	QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+
+	parser.addOptions({ nameOption, clientsOption, requestsOption, inflightOption, viewsOption, distinctOption, typeOption, sizeOption, seedOption });
+	parser.process(app);
+
+	QTextStream log(stderr);
+	LoadOptions options;
+
+	options.clients = std::max(parser.value(clientsOption).toInt(), 1);
+	options.requests = std::max(parser.value(requestsOption).toInt(), 1);
+	options.inflight = std::max(parser.value(inflightOption).toInt(), 1);
+	options.views = std::max(parser.value(viewsOption).toInt(), 1);
+	options.distinct = std::max(parser.value(distinctOption).toInt(), 0);
+
+	const int type = QStringList({ "slice", "mip", "view", "mixed" }).indexOf(parser.value(typeOption).toLower());
+
+	if (type < 0)
+	{
+		log << "Unknown request type: " << parser.value(typeOption) << endl;
+		return 1;
+	}
+
+	options.type = (LoadType)type;
+
+	const QStringList size = parser.value(sizeOption).toLower().split('x');
+
+	if (size.size() != 2 || size[0].toUInt() == 0 || size[1].toUInt() == 0 || size[0].toUInt() > 0xffff || size[1].toUInt() > 0xffff)
+	{
+		log << "Invalid size: " << parser.value(sizeOption) << endl;
+		return 1;
+	}
+
+	options.width = (quint16)size[0].toUInt();
+	options.height = (quint16)size[1].toUInt();
+
+	/*
+		Run clients
+	*/
+	QElapsedTimer timer;
+	LoadResults results;
+	QVector<LoadClient> clients(options.clients);
+	int finished = 0;
+	int failed = 0;
+
+	//Send requests until the client has the given number outstanding
+	auto issue = [&](LoadClient& client) {
+		while (client.issued < options.requests && client.sent.size() < options.inflight)
+		{
+			const RenderRequest request = nextRequest(client, options);
+			client.sent.insert(request.id, timer.nsecsElapsed());
+			client.socket->write(RenderProtocol::encodeRequest(request));
+			client.issued++;
+		}
+	};
+
+	auto done = [&]() {
+		if (finished + failed == options.clients)
+			app.quit();
+	};
+
+	timer.start();
+
+	for (int i = 0; i < clients.size(); i++)
+	{
+		LoadClient& client = clients[i];
+		client.rng.seed(parser.value(seedOption).toUInt() + i);
+		client.socket = new QLocalSocket(&app);
+
+		QObject::connect(client.socket, &QLocalSocket::readyRead, [&, i]() {
+
+			LoadClient& client = clients[i];
+
+			client.buffer.append(client.socket->readAll());
+
+			QByteArray message;
+
+			while (RenderProtocol::takeMessage(client.buffer, message))
+			{
+				//Server describes the volume first
+				if (RenderProtocol::messageKind(message) == MessageInfo)
+				{
+					RenderProtocol::decodeInfo(message, client.dimensions);
+					issue(client);
+					continue;
+				}
+
+				RenderResponse response;
+
+				if (!RenderProtocol::decodeResponse(message, response) || !client.sent.contains(response.id))
+				{
+					log << "Unexpected response from server" << endl;
+					continue;
+				}
+
+				const qint64 latency = timer.nsecsElapsed() - client.sent.take(response.id);
+
+				switch (response.status)
+				{
+				case RenderOk:
+					results.ok++;
+					results.bytes += response.pixels.size();
+					results.latencies.append(latency);
+					break;
+				case RenderSuperseded:
+					results.superseded++;
+					break;
+				case RenderInvalid:
+					results.invalid++;
+					break;
+				}
+
+				client.completed++;
+
+				if (client.completed == options.requests)
+				{
+					finished++;
+					done();
+				}
+			}
+
+			issue(client);
+		});
+
+		QObject::connect(client.socket, static_cast<void(QLocalSocket::*)(QLocalSocket::LocalSocketError)>(&QLocalSocket::error), [&, i](QLocalSocket::LocalSocketError) {
+
+			LoadClient& client = clients[i];
+
+			//The server closing the connection after the last response is not a failure
+			if (client.completed == options.requests)
+				return;
+
+			log << "Client " << i << ": " << client.socket->errorString() << endl;
+			client.completed = options.requests;
+			failed++;
+			done();
+		});
+
+		client.socket->connectToServer(parser.value(nameOption));
+	}
+
+	app.exec();
+
+	const double seconds = timer.nsecsElapsed() / 1.0e9;
+
+	if (failed == options.clients)
+		return 1;
+
+	/*
+		Report
+	*/
+	QVector<qint64>& latencies = results.latencies;
+	std::sort(latencies.begin(), latencies.end());
+
+	const quint64 responses = results.ok + results.superseded + results.invalid;
+	auto ms = [](qint64 ns) { return QString::number(ns / 1.0e6, 'f', 2); };
+
+	QTextStream out(stdout);
+
+	out << "clients:      " << options.clients << " (" << failed << " failed)" << endl;
+	out << "responses:    " << responses << " (" << results.ok << " ok, " << results.superseded << " superseded, " << results.invalid << " invalid)" << endl;
+	out << "elapsed:      " << QString::number(seconds, 'f', 3) << " s" << endl;
+	out << "requests/s:   " << QString::number((seconds > 0.0) ? (responses / seconds) : 0.0, 'f', 1) << endl;
+	out << "images/s:     " << QString::number((seconds > 0.0) ? (results.ok / seconds) : 0.0, 'f', 1) << endl;
+	out << "MB/s:         " << QString::number((seconds > 0.0) ? (results.bytes / seconds / 1.0e6) : 0.0, 'f', 1) << endl;
+	out << "latency (ms): "
+		<< "p50 " << ms(percentile(latencies, 0.50))
+		<< ", p90 " << ms(percentile(latencies, 0.90))
+		<< ", p99 " << ms(percentile(latencies, 0.99))
+		<< ", p99.9 " << ms(percentile(latencies, 0.999))
+		<< ", max " << ms(latencies.isEmpty() ? 0 : latencies.last())
+		<< endl;
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
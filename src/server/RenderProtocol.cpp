@@ -0,0 +1,238 @@
+/*
+	Render server protocol source
+*/
+
+#include <QDataStream>
+#include <QtEndian>
+
+#include "RenderProtocol.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Helpers
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Stream configured for the wire format
+*/
+static void setupStream(QDataStream& stream)
+{
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+/*
+	Prefix a payload with its length
+*/
+static QByteArray frame(const QByteArray& payload)
+{
+	QByteArray message;
+	message.reserve(payload.size() + 4);
+
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	setupStream(stream);
+	stream << (quint32)payload.size();
+
+	message.append(payload);
+
+	return message;
+}
+
+/*
+	Request fields following the id and view
+*/
+static void writeParameters(QDataStream& stream, const RenderRequest& request)
+{
+	stream << (quint8)request.axis << (quint32)request.index << request.width << request.height;
+
+	if (request.type == RequestView)
+	{
+		const float* m = request.camera.constData();
+
+		//Stored column-major, sent row-major
+		for (int row = 0; row < 4; row++)
+		{
+			for (int col = 0; col < 4; col++)
+			{
+				stream << m[col * 4 + row];
+			}
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool RenderProtocol::takeMessage(QByteArray& buffer, QByteArray& message, bool* error)
+{
+	if (error != nullptr)
+		*error = false;
+
+	if (buffer.size() < 4)
+		return false;
+
+	const quint32 size = qFromLittleEndian<quint32>((const uchar*)buffer.constData());
+
+	if (size > MaxMessageSize)
+	{
+		if (error != nullptr)
+			*error = true;
+
+		return false;
+	}
+
+	if ((quint32)buffer.size() < size + 4)
+		return false;
+
+	message = buffer.mid(4, (int)size);
+	buffer.remove(0, (int)size + 4);
+
+	return true;
+}
+
+QByteArray RenderProtocol::encodeRequest(const RenderRequest& request)
+{
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	setupStream(stream);
+
+	stream << (quint8)request.type << request.id << request.view;
+	writeParameters(stream, request);
+
+	return frame(payload);
+}
+
+QByteArray RenderProtocol::encodeResponse(const RenderResponse& response)
+{
+	QByteArray payload;
+	payload.reserve(ResponseHeaderSize + response.pixels.size());
+
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	setupStream(stream);
+
+	stream << (quint8)MessageImage << response.id << response.view << (quint8)response.status << response.width << response.height;
+
+	if (response.status == RenderOk)
+	{
+		stream.writeRawData(response.pixels.constData(), response.pixels.size());
+	}
+
+	return frame(payload);
+}
+
+QByteArray RenderProtocol::encodeInfo(const Volume::Dimensions& dimensions)
+{
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	setupStream(stream);
+
+	stream << (quint8)MessageInfo << (quint32)dimensions.sizeX << (quint32)dimensions.sizeY << (quint32)dimensions.sizeZ;
+
+	return frame(payload);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool RenderProtocol::decodeRequest(const QByteArray& message, RenderRequest& request)
+{
+	QDataStream stream(message);
+	setupStream(stream);
+
+	quint8 type = 0;
+	quint8 axis = 0;
+	quint32 index = 0;
+
+	stream >> type >> request.id >> request.view >> axis >> index >> request.width >> request.height;
+
+	if (type > RequestView || axis > ZAxis)
+		return false;
+
+	request.type = (RenderRequestType)type;
+	request.axis = (VolumeAxis)axis;
+	request.index = index;
+
+	if (request.type == RequestView)
+	{
+		float m[16];
+
+		for (int i = 0; i < 16; i++)
+		{
+			stream >> m[i];
+		}
+
+		request.camera = QMatrix4x4(m);
+	}
+
+	return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+bool RenderProtocol::decodeResponse(const QByteArray& message, RenderResponse& response)
+{
+	QDataStream stream(message);
+	setupStream(stream);
+
+	quint8 kind = 0;
+	quint8 status = 0;
+
+	stream >> kind >> response.id >> response.view >> status >> response.width >> response.height;
+
+	if (kind != MessageImage || status > RenderInvalid)
+		return false;
+
+	response.status = (RenderStatus)status;
+
+	if (response.status == RenderOk)
+	{
+		const int size = (int)response.width * response.height;
+		response.pixels.resize(size);
+
+		if (stream.readRawData(response.pixels.data(), size) != size)
+			return false;
+	}
+
+	return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+bool RenderProtocol::decodeInfo(const QByteArray& message, Volume::Dimensions& dimensions)
+{
+	QDataStream stream(message);
+	setupStream(stream);
+
+	quint8 kind = 0;
+	quint32 x = 0, y = 0, z = 0;
+
+	stream >> kind >> x >> y >> z;
+
+	if (kind != MessageInfo)
+		return false;
+
+	dimensions = Volume::Dimensions(x, y, z, 1, 1, 1);
+
+	return stream.status() == QDataStream::Ok;
+}
+
+RenderMessageKind RenderProtocol::messageKind(const QByteArray& message)
+{
+	return (!message.isEmpty() && (quint8)message[0] == MessageInfo) ? MessageInfo : MessageImage;
+}
+
+QByteArray RenderProtocol::imageKey(const RenderRequest& request)
+{
+	QByteArray key;
+	QDataStream stream(&key, QIODevice::WriteOnly);
+	setupStream(stream);
+
+	//Fields which do not affect the image are cleared so equivalent requests share a key
+	RenderRequest image = request;
+
+	if (image.type != RequestSubimage)
+		image.index = 0;
+
+	if (image.type == RequestView)
+		image.axis = ZAxis;
+
+	stream << (quint8)image.type;
+	writeParameters(stream, image);
+
+	return key;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
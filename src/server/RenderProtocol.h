@@ -0,0 +1,130 @@
+/*
+	Render server protocol
+
+	Messages are framed by a 32 bit little endian length followed by the payload.
+	All fields are little endian.
+
+	Client -> server:
+
+		Request
+			u8   type      RenderRequestType
+			u32  id        chosen by the client, echoed in the response
+			u16  view      requests for the same view supersede each other
+			u8   axis      subimage axis
+			u32  index     subimage index
+			u16  width
+			u16  height
+			f32  camera[16] row-major model view matrix, RequestView only
+
+	Server -> client:
+
+		Info, sent once after connecting
+			u8   kind      MessageInfo
+			u32  sizeX, sizeY, sizeZ
+
+		Image
+			u8   kind      MessageImage
+			u32  id
+			u16  view
+			u8   status    RenderStatus
+			u16  width
+			u16  height
+			u8   pixels[width * height] grey scale rows without padding, RenderOk only
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QMatrix4x4>
+
+#include "gfx/Volume.h"
+
+enum RenderRequestType
+{
+	RequestSubimage,
+	RequestSubimageMIP,
+	RequestView
+};
+
+enum RenderMessageKind
+{
+	MessageInfo,
+	MessageImage
+};
+
+enum RenderStatus
+{
+	RenderOk,
+	RenderSuperseded, //A newer request for the same view arrived before this one was drawn
+	RenderInvalid     //The request could not be decoded or is out of range
+};
+
+/*
+	Render request
+*/
+struct RenderRequest
+{
+	RenderRequestType type = RequestSubimage;
+	quint32 id = 0;
+	quint16 view = 0;
+	VolumeAxis axis = ZAxis;
+	Volume::IndexType index = 0;
+	quint16 width = 0;
+	quint16 height = 0;
+	QMatrix4x4 camera;
+};
+
+/*
+	Render response
+*/
+struct RenderResponse
+{
+	quint32 id = 0;
+	quint16 view = 0;
+	RenderStatus status = RenderOk;
+	quint16 width = 0;
+	quint16 height = 0;
+	QByteArray pixels;
+};
+
+class RenderProtocol
+{
+public:
+
+	//Largest accepted message, bounds the memory a peer can make the other side buffer
+	static const quint32 MaxMessageSize = 64 * 1024 * 1024;
+
+	//Size of the fields of an image response preceding its pixels
+	static const quint32 ResponseHeaderSize = 12;
+
+	/*
+		Remove the next complete message from a receive buffer.
+
+		Returns false if the buffer does not hold a complete message yet, or holds an oversized one (error is set).
+	*/
+	static bool takeMessage(QByteArray& buffer, QByteArray& message, bool* error = nullptr);
+
+	/*
+		Encode messages including their length prefix
+	*/
+	static QByteArray encodeRequest(const RenderRequest& request);
+	static QByteArray encodeResponse(const RenderResponse& response);
+	static QByteArray encodeInfo(const Volume::Dimensions& dimensions);
+
+	/*
+		Decode message payloads
+	*/
+	static bool decodeRequest(const QByteArray& message, RenderRequest& request);
+	static bool decodeResponse(const QByteArray& message, RenderResponse& response);
+	static bool decodeInfo(const QByteArray& message, Volume::Dimensions& dimensions);
+
+	/*
+		Kind of a server message
+	*/
+	static RenderMessageKind messageKind(const QByteArray& message);
+
+	/*
+		Key identifying the image a request draws, equal for requests which draw the same image
+	*/
+	static QByteArray imageKey(const RenderRequest& request);
+};
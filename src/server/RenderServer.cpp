@@ -0,0 +1,277 @@
+/*
+	Render server source
+*/
+
+#include <QtConcurrentRun>
+#include <QFutureWatcher>
+
+#include "RenderServer.h"
+#include "util/Trace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QString RenderServerStats::toString() const
+{
+	return QString("%1 requests, %2 renders, %3 cache hits, %4 shared, %5 superseded, %6 invalid")
+		.arg(requests)
+		.arg(renders)
+		.arg(cacheHits)
+		.arg(shared)
+		.arg(superseded)
+		.arg(invalid);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderServer::RenderServer(VolumeRender* render, qint64 cacheBytes, QObject* parent) :
+	QObject(parent),
+	m_render(render),
+	m_cache((int)std::max<qint64>(cacheBytes / 1024, 1))
+{
+	Q_ASSERT(render != nullptr);
+
+	connect(&m_server, &QLocalServer::newConnection, this, &RenderServer::connected);
+}
+
+RenderServer::~RenderServer()
+{
+	qDeleteAll(m_clients);
+}
+
+bool RenderServer::listen(const QString& name, QString* error)
+{
+	//Remove a socket left behind by a server which did not shut down cleanly
+	QLocalServer::removeServer(name);
+
+	if (!m_server.listen(name))
+	{
+		if (error != nullptr)
+			*error = m_server.errorString();
+
+		return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Connections
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RenderServer::connected()
+{
+	while (QLocalSocket* socket = m_server.nextPendingConnection())
+	{
+		const quint64 id = m_nextClient++;
+
+		Client* client = new Client();
+		client->id = id;
+		client->socket = socket;
+		m_clients.insert(id, client);
+
+		connect(socket, &QLocalSocket::readyRead, this, [this, id]() {
+			receive(m_clients.value(id));
+		});
+
+		connect(socket, &QLocalSocket::disconnected, this, [this, id, socket]() {
+			//Draws in progress finish, their results are only cached
+			delete m_clients.take(id);
+			socket->deleteLater();
+		});
+
+		//Tell the client what it can ask for
+		socket->write(RenderProtocol::encodeInfo(m_render->volume()->dimensions()));
+	}
+}
+
+void RenderServer::receive(Client* client)
+{
+	if (client == nullptr)
+		return;
+
+	client->buffer.append(client->socket->readAll());
+
+	QByteArray message;
+	bool error = false;
+
+	while (RenderProtocol::takeMessage(client->buffer, message, &error))
+	{
+		RenderRequest request;
+		m_stats.requests++;
+
+		if (!RenderProtocol::decodeRequest(message, request) || !validate(request))
+		{
+			m_stats.invalid++;
+			respond(client, request, RenderInvalid);
+			continue;
+		}
+
+		//Only the newest request of a view is kept
+		if (client->pending.contains(request.view))
+		{
+			m_stats.superseded++;
+			respond(client, client->pending.value(request.view), RenderSuperseded);
+		}
+
+		client->pending.insert(request.view, request);
+	}
+
+	if (error)
+	{
+		client->socket->abort();
+		return;
+	}
+
+	schedule(client);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Rendering
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RenderServer::schedule(Client* client)
+{
+	for (auto it = client->pending.begin(); it != client->pending.end();)
+	{
+		//Wait for the draw of the previous request of this view
+		if (client->busy.contains(it.key()))
+		{
+			++it;
+			continue;
+		}
+
+		const RenderRequest request = it.value();
+		it = client->pending.erase(it);
+
+		const QByteArray key = RenderProtocol::imageKey(request);
+
+		//Already drawn
+		if (const QByteArray* pixels = m_cache.object(key))
+		{
+			m_stats.cacheHits++;
+			respond(client, request, RenderOk, *pixels);
+			continue;
+		}
+
+		client->busy.insert(request.view);
+
+		//Join a draw of the same image which is already in progress
+		if (m_inflight.contains(key))
+		{
+			m_stats.shared++;
+			m_inflight[key].append({ client->id, request });
+			continue;
+		}
+
+		m_inflight.insert(key, { { client->id, request } });
+		render(key, request);
+	}
+}
+
+void RenderServer::render(const QByteArray& key, const RenderRequest& request)
+{
+	m_stats.renders++;
+
+	VolumeRender* render = m_render;
+
+	auto watcher = new QFutureWatcher<QByteArray>(this);
+
+	connect(watcher, &QFutureWatcher<QByteArray>::finished, this, [this, watcher, key]() {
+		finished(key, watcher->result());
+		watcher->deleteLater();
+	});
+
+	watcher->setFuture(QtConcurrent::run([render, request]() {
+
+		TRACE_SCOPE("serveRequest");
+
+		ImageBuffer target(request.width, request.height, ImageBuffer::Gray8);
+
+		switch (request.type)
+		{
+		case RequestSubimage:    render->drawSubimage(target, request.index, request.axis); break;
+		case RequestSubimageMIP: render->drawSubimageMIP(target, request.axis); break;
+		case RequestView:        render->draw3D(target, request.camera); break;
+		}
+
+		//Strip row padding
+		//Bounded by the message size limit, see validate
+		const size_t size = (size_t)target.width() * target.height();
+		Q_ASSERT(size <= RenderProtocol::MaxMessageSize);
+
+		QByteArray pixels;
+		pixels.resize((int)size);
+
+		for (quint32 j = 0; j < target.height(); j++)
+		{
+			memcpy(pixels.data() + ((size_t)j * target.width()), target.scanLine(j), target.width());
+		}
+
+		return pixels;
+	}));
+}
+
+void RenderServer::finished(const QByteArray& key, const QByteArray& pixels)
+{
+	m_cache.insert(key, new QByteArray(pixels), std::max(pixels.size() / 1024, 1));
+
+	const QList<Waiter> waiters = m_inflight.take(key);
+	QList<Client*> ready;
+
+	for (const Waiter& waiter : waiters)
+	{
+		//Client may have disconnected while waiting
+		Client* client = m_clients.value(waiter.client);
+
+		if (client == nullptr)
+			continue;
+
+		respond(client, waiter.request, RenderOk, pixels);
+		client->busy.remove(waiter.request.view);
+
+		if (!ready.contains(client))
+			ready.append(client);
+	}
+
+	//Start on requests which arrived during the draw
+	for (Client* client : ready)
+	{
+		schedule(client);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RenderServer::respond(Client* client, const RenderRequest& request, RenderStatus status, const QByteArray& pixels)
+{
+	RenderResponse response;
+	response.id = request.id;
+	response.view = request.view;
+	response.status = status;
+
+	if (status == RenderOk)
+	{
+		response.width = request.width;
+		response.height = request.height;
+		response.pixels = pixels;
+	}
+
+	client->socket->write(RenderProtocol::encodeResponse(response));
+}
+
+bool RenderServer::validate(const RenderRequest& request) const
+{
+	if (request.width == 0 || request.height == 0)
+		return false;
+
+	//The response must fit in one message
+	if ((quint64)request.width * request.height + RenderProtocol::ResponseHeaderSize > RenderProtocol::MaxMessageSize)
+		return false;
+
+	if (request.type == RequestSubimage && request.index >= m_render->volume()->axisSize(request.axis))
+		return false;
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,120 @@
+/*
+	Render server
+
+	Serves subimage, MIP and 3D view render requests for a single volume to local clients.
+
+	Requests from a client are coalesced per view: while an image for a view is being drawn,
+	newer requests for that view replace any waiting request, and the replaced ones are answered
+	as superseded. Rendered images are kept in a cache shared by all clients, and clients asking
+	for an image which is already being drawn wait for that draw instead of starting another.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QCache>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "gfx/VolumeRender.h"
+#include "RenderProtocol.h"
+
+/*
+	Server counters
+*/
+struct RenderServerStats
+{
+	quint64 requests = 0;
+	quint64 superseded = 0;
+	quint64 invalid = 0;
+	quint64 cacheHits = 0;
+	quint64 shared = 0;   //requests which joined a draw already in progress
+	quint64 renders = 0;
+
+	QString toString() const;
+};
+
+class RenderServer : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(RenderServer)
+
+public:
+
+	/*
+		Construct a server for a renderer, caching up to the given number of bytes of images
+	*/
+	RenderServer(VolumeRender* render, qint64 cacheBytes, QObject* parent = nullptr);
+
+	~RenderServer();
+
+	/*
+		Start listening on a local socket name
+	*/
+	bool listen(const QString& name, QString* error = nullptr);
+
+	/*
+		Counters since the server started
+	*/
+	RenderServerStats stats() const { return m_stats; }
+
+private slots:
+
+	void connected();
+
+private:
+
+	/*
+		State of a connected client
+	*/
+	struct Client
+	{
+		quint64 id = 0;
+		QLocalSocket* socket = nullptr;
+		QByteArray buffer;
+
+		//Newest waiting request of each view
+		QHash<quint16, RenderRequest> pending;
+		//Views with a draw in progress
+		QSet<quint16> busy;
+	};
+
+	/*
+		Client waiting for an image
+	*/
+	struct Waiter
+	{
+		quint64 client;
+		RenderRequest request;
+	};
+
+	//Read and queue requests of a client
+	void receive(Client* client);
+	//Start drawing the waiting requests of a client
+	void schedule(Client* client);
+	//Draw an image on the thread pool
+	void render(const QByteArray& key, const RenderRequest& request);
+	//Answer everyone waiting for a finished image
+	void finished(const QByteArray& key, const QByteArray& pixels);
+
+	void respond(Client* client, const RenderRequest& request, RenderStatus status, const QByteArray& pixels = QByteArray());
+	bool validate(const RenderRequest& request) const;
+
+	VolumeRender* m_render;
+	QLocalServer m_server;
+
+	//Connected clients by id, ids are never reused
+	QHash<quint64, Client*> m_clients;
+	quint64 m_nextClient = 0;
+
+	//Images being drawn and the clients waiting for them
+	QHash<QByteArray, QList<Waiter>> m_inflight;
+
+	//Rendered images, cost in kilobytes
+	QCache<QByteArray, QByteArray> m_cache;
+
+	RenderServerStats m_stats;
+};
@@ -0,0 +1,101 @@
+/*
+	Render server entry point
+
+	Loads the volume described by a config file once and serves render requests to local clients.
+
+	Example:
+		RenderServer --config config.ini --name ct-render --cache 512
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QTimer>
+
+#include "gfx/VolumeLoader.h"
+#include "RenderServer.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("RenderServer");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Local volume render server");
+	parser.addHelpOption();
+
+	QCommandLineOption configOption("config", "Volume config file.", "file", "config.ini");
+	QCommandLineOption nameOption("name", "Local socket name to listen on.", "name", "ct-render");
+	QCommandLineOption cacheOption("cache", "Size of the rendered image cache in megabytes.", "megabytes", "256");
+	QCommandLineOption samplerOption("sampler", "Subimage sampler (nearest, bilinear or bicubic).", "sampler", "bilinear");
+	QCommandLineOption sampler3DOption("sampler3d", "3D view sampler (nearest or trilinear).", "sampler", "trilinear");
+	QCommandLineOption histOption("hist", "Use histogram equalization.");
+	QCommandLineOption adaptiveOption("clahe", "Use contrast limited adaptive histogram equalization.");
+	QCommandLineOption frequencyOption("frequency", "Raycast sample frequency.", "frequency", "125");
+	QCommandLineOption reportOption("report", "Print server counters every given number of seconds.", "seconds", "0");
+
+	parser.addOptions({ configOption, nameOption, cacheOption, samplerOption, sampler3DOption, histOption, adaptiveOption, frequencyOption, reportOption });
+	parser.process(app);
+
+	QTextStream log(stderr);
+
+	/*
+		Load volume
+	*/
+	Volume volume;
+	QString error;
+
+	if (!VolumeLoader::load(parser.value(configOption), volume, &error))
+	{
+		log << "Unable to load volume: " << error << endl;
+		return 1;
+	}
+
+	VolumeRender render(volume);
+
+	const int sampler = QStringList({ "nearest", "bilinear", "bicubic" }).indexOf(parser.value(samplerOption).toLower());
+	const int sampler3D = QStringList({ "nearest", "trilinear" }).indexOf(parser.value(sampler3DOption).toLower());
+
+	if (sampler < 0 || sampler3D < 0)
+	{
+		log << "Unknown sampler" << endl;
+		return 1;
+	}
+
+	render.setSamplingType((SamplerType2D)sampler);
+	render.setSamplingType3D((SamplerType3D)sampler3D);
+	render.enableHist(parser.isSet(histOption));
+	render.enableAdaptiveHist(parser.isSet(adaptiveOption));
+	render.setSampleFrequency(std::max(parser.value(frequencyOption).toUInt(), 1u));
+
+	/*
+		Serve
+	*/
+	RenderServer server(&render, parser.value(cacheOption).toLongLong() * 1024 * 1024);
+
+	if (!server.listen(parser.value(nameOption), &error))
+	{
+		log << "Unable to listen on " << parser.value(nameOption) << ": " << error << endl;
+		return 1;
+	}
+
+	log << "Serving " << parser.value(configOption) << " on " << parser.value(nameOption) << endl;
+
+	QTimer report;
+	const int reportSeconds = parser.value(reportOption).toInt();
+
+	if (reportSeconds > 0)
+	{
+		QObject::connect(&report, &QTimer::timeout, [&]() {
+			log << server.stats().toString() << endl;
+		});
+
+		report.start(reportSeconds * 1000);
+	}
+
+	return app.exec();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,513 @@
+/*
+	Batch renderer
+
+	Renders images of a volume to PNG files without a display, for use in automated pipelines.
+
+	The volume is loaded using the same config file as the application. Any combination of
+	chosen slices, every slice of an axis, maximum intensity projections and a list of camera
+	matrices can be rendered in a single run.
+
+	Whole images are rendered concurrently on the renderer's thread pool, each image also drawing its
+	rows in parallel when threads are free. Encoding is done on a separate pool so writing files
+	overlaps with rendering the next images.
+
+	A turntable sequence of evenly spaced rotations can be rendered for making rotating MIP movies.
+	With many frames whole frames are spread across the threads, with few frames the idle threads
+	draw rows of the frames in flight instead.
+
+	Example:
+		BatchRender --config config.ini --axis z --all --mip --out images
+		BatchRender --config config.ini --cameras views.txt --size 1024x1024 --out images
+		BatchRender --config config.ini --turntable 360 --tilt 20 --out frames
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThreadPool>
+#include <QThread>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include <QtConcurrentRun>
+
+#include "gfx/VolumeRender.h"
+#include "gfx/VolumeLoader.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Type of image to render
+*/
+enum RenderJobType
+{
+	JobSubimage,
+	JobSubimageMIP,
+	JobView
+};
+
+/*
+	Single image to render
+*/
+struct RenderJob
+{
+	RenderJobType type = JobSubimage;
+	VolumeAxis axis = ZAxis;
+	Volume::IndexType index = 0;
+	QMatrix4x4 camera;
+
+	quint32 width = 0;
+	quint32 height = 0;
+
+	QString path;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Helpers
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	Parse a list of slice indices and ranges, eg. "0-9,20,40-42"
+*/
+static bool parseSlices(const QString& text, Volume::SizeType count, QList<Volume::IndexType>& indices)
+{
+	for (const QString& item : text.split(',', QString::SkipEmptyParts))
+	{
+		const QStringList bounds = item.trimmed().split('-');
+
+		bool okFirst = false;
+		bool okLast = false;
+		const quint32 first = bounds.first().toUInt(&okFirst);
+		const quint32 last = (bounds.size() == 2) ? bounds.last().toUInt(&okLast) : first;
+
+		if (!okFirst || (bounds.size() == 2 && !okLast) || bounds.size() > 2 || first > last || last >= count)
+			return false;
+
+		for (quint32 i = first; i <= last; i++)
+		{
+			indices.append(i);
+		}
+	}
+
+	return !indices.isEmpty();
+}
+
+/*
+	Parse an image size given as WxH
+*/
+static bool parseSize(const QString& text, quint32& width, quint32& height)
+{
+	const QStringList parts = text.toLower().split('x');
+
+	if (parts.size() != 2)
+		return false;
+
+	bool okW = false;
+	bool okH = false;
+	width = parts[0].toUInt(&okW);
+	height = parts[1].toUInt(&okH);
+
+	return okW && okH && width > 0 && height > 0;
+}
+
+/*
+	Read camera matrices from a file
+
+	Each line holds the 16 values of a model view matrix in row-major order,
+	blank lines and lines starting with '#' are ignored.
+*/
+static bool readCameras(const QString& path, QList<QMatrix4x4>& cameras, QString& error)
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		error = file.errorString();
+		return false;
+	}
+
+	QTextStream in(&file);
+	int lineNumber = 0;
+
+	while (!in.atEnd())
+	{
+		const QString line = in.readLine().trimmed();
+		lineNumber++;
+
+		if (line.isEmpty() || line.startsWith('#'))
+			continue;
+
+		const QStringList values = line.split(QRegExp("[\\s,]+"), QString::SkipEmptyParts);
+
+		if (values.size() != 16)
+		{
+			error = QString("Expected 16 values on line %1").arg(lineNumber);
+			return false;
+		}
+
+		float m[16];
+
+		for (int i = 0; i < 16; i++)
+		{
+			bool ok = false;
+			m[i] = values[i].toFloat(&ok);
+
+			if (!ok)
+			{
+				error = QString("Invalid value '%1' on line %2").arg(values[i]).arg(lineNumber);
+				return false;
+			}
+		}
+
+		cameras.append(QMatrix4x4(m));
+	}
+
+	return true;
+}
+
+/*
+	Camera of a turntable frame, rotating the volume about its z axis.
+
+	Matches the default camera of the application's 3D view when the angle and tilt are zero.
+*/
+static QMatrix4x4 turntableCamera(float angle, float tilt)
+{
+	QMatrix4x4 view;
+	view.rotate(90.0f + tilt, 1, 0);
+	view.rotate(angle, 0, 0, 1);
+
+	QMatrix4x4 scaling;
+	scaling.scale(1.4f, 1.4f, 1.4f);
+
+	return view * scaling;
+}
+
+/*
+	Size of a subimage of an axis with voxel scaling applied, matching the application views
+*/
+static void subimageSize(const Volume& volume, VolumeAxis axis, quint32& width, quint32& height)
+{
+	const VolumeAxis axes[3][2] =
+	{
+		{ YAxis, ZAxis }, //x
+		{ XAxis, ZAxis }, //y
+		{ XAxis, YAxis }  //z
+	};
+
+	width = volume.axisSizeScaled(axes[axis][0]);
+	height = volume.axisSizeScaled(axes[axis][1]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	Entry point
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("BatchRender");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Headless volume renderer writing slices, projections and 3D views to PNG files");
+	parser.addHelpOption();
+
+	QCommandLineOption configOption("config", "Volume config file.", "file", "config.ini");
+	QCommandLineOption outOption("out", "Output directory.", "dir", ".");
+	QCommandLineOption prefixOption("prefix", "Output file name prefix.", "prefix", "render");
+	QCommandLineOption axisOption("axis", "Subimage axis (x, y or z).", "axis", "z");
+	QCommandLineOption slicesOption("slices", "Slices of the axis to render, eg. 0-9,20.", "slices");
+	QCommandLineOption allOption("all", "Render every slice of the axis.");
+	QCommandLineOption mipOption("mip", "Render a maximum intensity projection of the axis.");
+	QCommandLineOption camerasOption("cameras", "File of camera matrices to render 3D views from, 16 row-major values per line.", "file");
+	QCommandLineOption turntableOption("turntable", "Render a turntable sequence of the given number of frames.", "frames");
+	QCommandLineOption tiltOption("tilt", "Tilt of the turntable camera in degrees.", "degrees", "0");
+	QCommandLineOption sizeOption("size", "Output size as WxH, defaults to the scaled subimage size (512x512 for 3D views).", "size");
+	QCommandLineOption samplerOption("sampler", "Subimage sampler (nearest, bilinear or bicubic).", "sampler", "bilinear");
+	QCommandLineOption sampler3DOption("sampler3d", "3D view sampler (nearest or trilinear).", "sampler", "trilinear");
+	QCommandLineOption histOption("hist", "Use histogram equalization.");
+	QCommandLineOption adaptiveOption("clahe", "Use contrast limited adaptive histogram equalization.");
+	QCommandLineOption frequencyOption("frequency", "Raycast sample frequency.", "frequency", "125");
+	QCommandLineOption jobsOption("jobs", "Number of render threads.", "count", QString::number(QThread::idealThreadCount()));
+	QCommandLineOption encodersOption("encoders", "Number of PNG encoding threads.", "count", "2");
+	QCommandLineOption sequentialOption("sequential", "Render one image at a time, for comparison with concurrent rendering.");
+
+	parser.addOptions({
+		configOption, outOption, prefixOption,
+		axisOption, slicesOption, allOption, mipOption, camerasOption, turntableOption, tiltOption,
+		sizeOption, samplerOption, sampler3DOption, histOption, adaptiveOption, frequencyOption,
+		jobsOption, encodersOption, sequentialOption
+	});
+
+	parser.process(app);
+
+	QTextStream log(stderr);
+
+	/*
+		Load volume
+	*/
+	Volume volume;
+	QString error;
+
+	if (!VolumeLoader::load(parser.value(configOption), volume, &error))
+	{
+		log << "Unable to load volume: " << error << endl;
+		return 1;
+	}
+
+	VolumeRender render(volume);
+
+	/*
+		Render state
+	*/
+	const int sampler = QStringList({ "nearest", "bilinear", "bicubic" }).indexOf(parser.value(samplerOption).toLower());
+	const int sampler3D = QStringList({ "nearest", "trilinear" }).indexOf(parser.value(sampler3DOption).toLower());
+
+	if (sampler < 0 || sampler3D < 0)
+	{
+		log << "Unknown sampler" << endl;
+		return 1;
+	}
+
+	render.setSamplingType((SamplerType2D)sampler);
+	render.setSamplingType3D((SamplerType3D)sampler3D);
+	render.enableHist(parser.isSet(histOption));
+	render.enableAdaptiveHist(parser.isSet(adaptiveOption));
+	render.setSampleFrequency(std::max(parser.value(frequencyOption).toUInt(), 1u));
+
+	const int axisValue = QStringList({ "x", "y", "z" }).indexOf(parser.value(axisOption).toLower());
+
+	if (axisValue < 0)
+	{
+		log << "Unknown axis: " << parser.value(axisOption) << endl;
+		return 1;
+	}
+
+	const VolumeAxis axis = (VolumeAxis)axisValue;
+	const char* axisNames[] = { "x", "y", "z" };
+
+	//Output size
+	quint32 width = 0;
+	quint32 height = 0;
+
+	if (parser.isSet(sizeOption) && !parseSize(parser.value(sizeOption), width, height))
+	{
+		log << "Invalid output size: " << parser.value(sizeOption) << endl;
+		return 1;
+	}
+
+	//Output directory
+	QDir outDir(parser.value(outOption));
+
+	if (!outDir.mkpath("."))
+	{
+		log << "Unable to create output directory: " << outDir.path() << endl;
+		return 1;
+	}
+
+	const QString prefix = parser.value(prefixOption);
+
+	/*
+		Gather jobs
+	*/
+	QList<RenderJob> jobs;
+
+	quint32 subimageWidth = width;
+	quint32 subimageHeight = height;
+
+	if (width == 0)
+	{
+		subimageSize(*render.volume(), axis, subimageWidth, subimageHeight);
+	}
+
+	//Slices
+	QList<Volume::IndexType> slices;
+
+	if (parser.isSet(allOption))
+	{
+		for (Volume::IndexType i = 0; i < render.volume()->axisSize(axis); i++)
+		{
+			slices.append(i);
+		}
+	}
+	else if (parser.isSet(slicesOption) && !parseSlices(parser.value(slicesOption), render.volume()->axisSize(axis), slices))
+	{
+		log << "Invalid slices: " << parser.value(slicesOption) << endl;
+		return 1;
+	}
+
+	for (Volume::IndexType index : slices)
+	{
+		RenderJob job;
+		job.type = JobSubimage;
+		job.axis = axis;
+		job.index = index;
+		job.width = subimageWidth;
+		job.height = subimageHeight;
+		job.path = outDir.filePath(QString("%1_%2_%3.png").arg(prefix).arg(axisNames[axis]).arg(index, 4, 10, QChar('0')));
+		jobs.append(job);
+	}
+
+	//Projection
+	if (parser.isSet(mipOption))
+	{
+		RenderJob job;
+		job.type = JobSubimageMIP;
+		job.axis = axis;
+		job.width = subimageWidth;
+		job.height = subimageHeight;
+		job.path = outDir.filePath(QString("%1_%2_mip.png").arg(prefix).arg(axisNames[axis]));
+		jobs.append(job);
+	}
+
+	//3D views
+	if (parser.isSet(camerasOption))
+	{
+		QList<QMatrix4x4> cameras;
+
+		if (!readCameras(parser.value(camerasOption), cameras, error))
+		{
+			log << "Unable to read cameras: " << error << endl;
+			return 1;
+		}
+
+		for (int i = 0; i < cameras.size(); i++)
+		{
+			RenderJob job;
+			job.type = JobView;
+			job.camera = cameras[i];
+			job.width = (width != 0) ? width : 512;
+			job.height = (height != 0) ? height : 512;
+			job.path = outDir.filePath(QString("%1_view_%2.png").arg(prefix).arg(i, 4, 10, QChar('0')));
+			jobs.append(job);
+		}
+	}
+
+	//Turntable
+	if (parser.isSet(turntableOption))
+	{
+		const int frames = parser.value(turntableOption).toInt();
+		const float tilt = parser.value(tiltOption).toFloat();
+
+		if (frames <= 0)
+		{
+			log << "Invalid turntable frame count: " << parser.value(turntableOption) << endl;
+			return 1;
+		}
+
+		for (int i = 0; i < frames; i++)
+		{
+			RenderJob job;
+			job.type = JobView;
+			job.camera = turntableCamera(360.0f * i / frames, tilt);
+			job.width = (width != 0) ? width : 512;
+			job.height = (height != 0) ? height : 512;
+			job.path = outDir.filePath(QString("%1_turn_%2.png").arg(prefix).arg(i, 4, 10, QChar('0')));
+			jobs.append(job);
+		}
+	}
+
+	if (jobs.isEmpty())
+	{
+		log << "Nothing to render, use --slices, --all, --mip, --cameras or --turntable" << endl;
+		return 1;
+	}
+
+	/*
+		Render
+	*/
+
+	//The thread submitting work takes part in rendering
+	const int threads = std::max(parser.value(jobsOption).toInt(), 1);
+	render.threadPool()->setWorkerCount(threads - 1);
+
+	//Encoding runs on its own threads so it overlaps with rendering
+	QThreadPool encoders;
+	encoders.setMaxThreadCount(std::max(parser.value(encodersOption).toInt(), 1));
+
+	//Bound the number of finished images waiting to be encoded
+	QSemaphore pending(4 * encoders.maxThreadCount());
+
+	QAtomicInt failures(0);
+
+	log << "Rendering " << jobs.size() << " images on " << threads << " threads..." << endl;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	auto renderJob = [&](const RenderJob& job, RenderPriority priority) {
+
+		ImageBuffer target(job.width, job.height, ImageBuffer::Gray8);
+
+		switch (job.type)
+		{
+		case JobSubimage:    render.drawSubimage(target, job.index, job.axis, priority); break;
+		case JobSubimageMIP: render.drawSubimageMIP(target, job.axis, priority); break;
+		case JobView:        render.draw3D(target, job.camera, priority); break;
+		}
+
+		//Detach image from the buffer before handing it to an encoder
+		const QImage image = target.toImage().copy();
+		const QString path = job.path;
+
+		pending.acquire();
+
+		QtConcurrent::run(&encoders, [&, image, path]() {
+
+			if (!image.save(path, "PNG"))
+			{
+				failures.ref();
+			}
+
+			pending.release();
+		});
+	};
+
+	if (parser.isSet(sequentialOption))
+	{
+		//One image at a time, only rows are drawn in parallel
+		for (const RenderJob& job : jobs)
+		{
+			renderJob(job, PriorityInteractive);
+		}
+	}
+	else
+	{
+		//Images are drawn concurrently. Rows are lower priority than whole images,
+		//so threads only help with the rows of images in flight once every image has been started.
+		//Lazily built data such as macrocells and pyramids is shared by all images.
+		render.threadPool()->parallelFor(jobs.size(), PriorityView, [&](size_t i) {
+			renderJob(jobs[(int)i], PriorityBackground);
+		});
+	}
+
+	const qint64 renderNs = timer.nsecsElapsed();
+
+	//Wait for remaining images to be written
+	encoders.waitForDone();
+
+	const qint64 totalNs = timer.nsecsElapsed();
+
+	/*
+		Report
+	*/
+	const int written = jobs.size() - failures.load();
+	const double seconds = totalNs / 1.0e9;
+
+	if (failures.load() > 0)
+	{
+		log << "Failed to write " << failures.load() << " images" << endl;
+	}
+
+	log << QString("%1 images in %2 s: %3 images/s (rendering %4 s)")
+		.arg(written)
+		.arg(seconds, 0, 'f', 3)
+		.arg((seconds > 0.0) ? (written / seconds) : 0.0, 0, 'f', 2)
+		.arg(renderNs / 1.0e9, 0, 'f', 3)
+		<< endl;
+
+	return (failures.load() > 0) ? 1 : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
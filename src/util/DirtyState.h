@@ -0,0 +1,91 @@
+/*
+	Dirty state helper
+
+	Tracks which inputs of an object have changed since it was last updated, and runs the update
+	once on the next turn of the event loop. Any number of invalidations made within one turn
+	result in a single update.
+
+	Inputs are bit flags chosen by the owner. Only invalidations of inputs the owner depends on
+	mark it dirty.
+*/
+
+#pragma once
+
+#include <functional>
+
+#include <QObject>
+#include <QTimer>
+
+class DirtyState
+{
+public:
+
+	//Depend on every input
+	static const quint32 AllInputs = 0xffffffff;
+
+	/*
+		Construct a dirty state running an update function in the thread of the given context object
+	*/
+	DirtyState(QObject* context, const std::function<void(quint32)>& update, quint32 dependencies = AllInputs) :
+		m_context(context),
+		m_update(update),
+		m_dependencies(dependencies)
+	{
+		Q_ASSERT(context != nullptr);
+	}
+
+	/*
+		Mark inputs as changed, an update is scheduled if any are depended on
+	*/
+	void invalidate(quint32 inputs)
+	{
+		inputs &= m_dependencies;
+
+		if (inputs == 0)
+			return;
+
+		//Already scheduled for this turn of the event loop
+		if (m_pending == 0)
+		{
+			QTimer::singleShot(0, m_context, [this]() { flush(); });
+		}
+
+		m_pending |= inputs;
+	}
+
+	/*
+		Run the update now if any inputs have changed
+	*/
+	void flush()
+	{
+		if (m_pending == 0)
+			return;
+
+		const quint32 inputs = m_pending;
+		m_pending = 0;
+
+		m_update(inputs);
+	}
+
+	/*
+		Inputs the owner depends on
+	*/
+	quint32 dependencies() const { return m_dependencies; }
+	void setDependencies(quint32 dependencies) { m_dependencies = dependencies; }
+
+	/*
+		Inputs changed since the last update
+	*/
+	quint32 pending() const { return m_pending; }
+	bool dirty() const { return m_pending != 0; }
+
+private:
+
+	Q_DISABLE_COPY(DirtyState)
+
+	QObject* m_context;
+	std::function<void(quint32)> m_update;
+
+	quint32 m_dependencies;
+	quint32 m_pending = 0;
+};
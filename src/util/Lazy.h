@@ -0,0 +1,62 @@
+/*
+	Lazily constructed value helper
+
+	Holds a value which is only built the first time it is requested.
+	Safe to request from multiple threads, the value is built exactly once.
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <QMutex>
+#include <QMutexLocker>
+
+template<typename Type>
+class Lazy
+{
+public:
+
+	Lazy() {}
+
+	/*
+		Fetch the value, building it with the given function if it does not exist yet
+	*/
+	template<typename BuildFunc>
+	const Type& get(const BuildFunc& build)
+	{
+		QMutexLocker lock(&m_mutex);
+
+		if (!m_value)
+		{
+			m_value.reset(new Type(build()));
+		}
+
+		return *m_value;
+	}
+
+	/*
+		True if the value has been built
+	*/
+	bool ready() const
+	{
+		QMutexLocker lock(&m_mutex);
+		return (bool)m_value;
+	}
+
+	/*
+		Discard the value, it is rebuilt on the next request
+	*/
+	void reset()
+	{
+		QMutexLocker lock(&m_mutex);
+		m_value.reset();
+	}
+
+private:
+
+	Q_DISABLE_COPY(Lazy)
+
+	mutable QMutex m_mutex;
+	std::unique_ptr<Type> m_value;
+};
@@ -0,0 +1,235 @@
+/*
+	Tracing helpers source
+
+	Each thread owns a ring buffer which only it writes to.
+	The write position is published with release ordering, so a reader can copy a consistent
+	range of events without locking and discard any that were overwritten while copying.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QCoreApplication>
+
+#include "Trace.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::atomic<bool> Trace::s_enabled(false);
+
+namespace
+{
+	/*
+		Recorded event
+	*/
+	struct TraceEvent
+	{
+		const char* name;
+		qint64 begin;
+		qint64 end;
+		qint64 arg;
+	};
+
+	/*
+		Ring buffer of events of a single thread
+	*/
+	struct TraceBuffer
+	{
+		int tid = 0;
+		QString threadName;
+
+		//Total number of events written
+		std::atomic<quint64> head;
+		//Events before this position are discarded
+		std::atomic<quint64> tail;
+
+		std::unique_ptr<TraceEvent[]> events;
+
+		TraceBuffer() :
+			head(0),
+			tail(0),
+			events(new TraceEvent[Trace::Capacity])
+		{}
+	};
+
+	/*
+		Registry of every thread buffer.
+
+		Buffers are never freed so events of finished threads can still be written out.
+	*/
+	struct TraceRegistry
+	{
+		QMutex mutex;
+		std::vector<std::unique_ptr<TraceBuffer>> buffers;
+		QElapsedTimer clock;
+
+		TraceRegistry() { clock.start(); }
+	};
+
+	TraceRegistry& registry()
+	{
+		static TraceRegistry r;
+		return r;
+	}
+
+	//Buffer of calling thread, registered on first use
+	TraceBuffer& localBuffer()
+	{
+		thread_local TraceBuffer* buffer = nullptr;
+
+		if (buffer == nullptr)
+		{
+			TraceRegistry& r = registry();
+			QMutexLocker lock(&r.mutex);
+
+			r.buffers.emplace_back(new TraceBuffer());
+			buffer = r.buffers.back().get();
+			buffer->tid = (int)r.buffers.size();
+
+			QThread* thread = QThread::currentThread();
+
+			if (QCoreApplication::instance() != nullptr && thread == QCoreApplication::instance()->thread())
+				buffer->threadName = QStringLiteral("Main");
+			else if (thread != nullptr && !thread->objectName().isEmpty())
+				buffer->threadName = thread->objectName();
+			else
+				buffer->threadName = QStringLiteral("Worker %1").arg(buffer->tid);
+		}
+
+		return *buffer;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Trace::setEnabled(bool enable)
+{
+	//Make sure the clock is started before the first event
+	registry();
+
+	s_enabled.store(enable, std::memory_order_relaxed);
+}
+
+qint64 Trace::now()
+{
+	return registry().clock.nsecsElapsed();
+}
+
+void Trace::record(const char* name, qint64 begin, qint64 end, qint64 arg)
+{
+	TraceBuffer& buffer = localBuffer();
+
+	//Only this thread writes the head, a relaxed load is enough
+	const quint64 head = buffer.head.load(std::memory_order_relaxed);
+
+	TraceEvent& e = buffer.events[head % Capacity];
+	e.name = name;
+	e.begin = begin;
+	e.end = end;
+	e.arg = arg;
+
+	//Publish event
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::clear()
+{
+	TraceRegistry& r = registry();
+	QMutexLocker lock(&r.mutex);
+
+	for (auto& buffer : r.buffers)
+	{
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+bool Trace::write(const QString& path, QString* error)
+{
+	QJsonArray events;
+
+	{
+		TraceRegistry& r = registry();
+		QMutexLocker lock(&r.mutex);
+
+		for (auto& buffer : r.buffers)
+		{
+			//Name thread in viewer
+			QJsonObject meta;
+			meta["name"] = QStringLiteral("thread_name");
+			meta["ph"] = QStringLiteral("M");
+			meta["pid"] = 1;
+			meta["tid"] = buffer->tid;
+			meta["args"] = QJsonObject({ { "name", buffer->threadName } });
+			events.append(meta);
+
+			//Copy readable range of ring buffer
+			const quint64 head = buffer->head.load(std::memory_order_acquire);
+			const quint64 tail = buffer->tail.load(std::memory_order_relaxed);
+			const quint64 begin = std::max(tail, (head > (quint64)Capacity) ? head - Capacity : (quint64)0);
+
+			std::vector<TraceEvent> copy;
+			copy.reserve((size_t)(head - begin));
+
+			for (quint64 i = begin; i < head; i++)
+			{
+				copy.push_back(buffer->events[i % Capacity]);
+			}
+
+			//Events overwritten by the owning thread while copying are dropped,
+			//including the slot of event newHead, which may be being written now
+			const quint64 newHead = buffer->head.load(std::memory_order_acquire);
+			const quint64 valid = (newHead + 1 > (quint64)Capacity) ? newHead + 1 - Capacity : (quint64)0;
+
+			for (quint64 i = std::max(begin, valid); i < head; i++)
+			{
+				const TraceEvent& e = copy[(size_t)(i - begin)];
+
+				//Complete event, timestamps in microseconds
+				QJsonObject obj;
+				obj["name"] = QString::fromLatin1(e.name);
+				obj["cat"] = QStringLiteral("render");
+				obj["ph"] = QStringLiteral("X");
+				obj["ts"] = e.begin / 1000.0;
+				obj["dur"] = (e.end - e.begin) / 1000.0;
+				obj["pid"] = 1;
+				obj["tid"] = buffer->tid;
+
+				if (e.arg != NoArg)
+				{
+					obj["args"] = QJsonObject({ { "value", (double)e.arg } });
+				}
+
+				events.append(obj);
+			}
+		}
+	}
+
+	QJsonObject root;
+	root["traceEvents"] = events;
+	root["displayTimeUnit"] = QStringLiteral("ms");
+
+	QFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		if (error != nullptr)
+			*error = file.errorString();
+
+		return false;
+	}
+
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
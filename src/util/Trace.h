@@ -0,0 +1,106 @@
+/*
+	Tracing helpers
+
+	Records scoped timing events into per-thread ring buffers,
+	which can be written out as Chrome trace event JSON (chrome://tracing, Perfetto).
+
+	Usage:
+		TRACE_SCOPE("name");             //times the enclosing scope
+		TRACE_SCOPE_ARG("name", value);  //with an integer argument
+
+	Names must be string literals.
+	When tracing is disabled a trace point costs a single relaxed atomic load,
+	defining NO_TRACING removes trace points entirely.
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include <QString>
+
+class Trace
+{
+public:
+
+	/*
+		Enable/disable recording of trace events
+	*/
+	static void setEnabled(bool enable);
+	static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+	/*
+		Discard all recorded events
+	*/
+	static void clear();
+
+	/*
+		Write recorded events to a file in Chrome trace event format
+	*/
+	static bool write(const QString& path, QString* error = nullptr);
+
+	/*
+		Timestamp in nanoseconds relative to the start of the process
+	*/
+	static qint64 now();
+
+	/*
+		Record a completed event on the calling thread
+	*/
+	static void record(const char* name, qint64 begin, qint64 end, qint64 arg);
+
+	//Events kept per thread, older events are overwritten
+	static const int Capacity = 1 << 16;
+
+	//Value of events recorded without an argument
+	static const qint64 NoArg = -1;
+
+private:
+
+	static std::atomic<bool> s_enabled;
+};
+
+/*
+	Scoped trace event
+*/
+class TraceScope
+{
+public:
+
+	explicit TraceScope(const char* name, qint64 arg = Trace::NoArg) :
+		m_name(Trace::enabled() ? name : nullptr),
+		m_arg(arg)
+	{
+		if (m_name != nullptr)
+		{
+			m_begin = Trace::now();
+		}
+	}
+
+	~TraceScope()
+	{
+		if (m_name != nullptr)
+		{
+			Trace::record(m_name, m_begin, Trace::now(), m_arg);
+		}
+	}
+
+private:
+
+	Q_DISABLE_COPY(TraceScope)
+
+	const char* m_name;
+	qint64 m_arg;
+	qint64 m_begin = 0;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef NO_TRACING
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, arg)
+#else
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name, (qint64)(arg))
+#endif